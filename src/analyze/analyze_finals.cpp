@@ -4,11 +4,11 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
 {
     const auto &db_ = sm_manager_->db_;
 
-    std::shared_ptr<Query> query = std::make_shared<Query>();
+    std::shared_ptr<Query> query = arena_make_shared<Query>();
     if (auto x = std::dynamic_pointer_cast<ast::SelectStmt>(parse))
     {
-        // 处理表名
-        query->tables = std::move(x->tabs);
+        // 处理表名；预备语句的计划失效后会重新分析同一棵语法树，这里不能移走其中的内容
+        query->tables = x->tabs;
 
         for (const auto &table : query->tables)
         {
@@ -43,6 +43,7 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
             for (const auto &col : all_cols)
             {
                 TabCol sel_col = {.tab_name = col.tab_name, .col_name = col.name};
+                sel_col.bind(col);
                 query->cols.push_back(sel_col);
             }
         }
@@ -63,6 +64,12 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         // 处理where条件
         get_clause(x->conds, query->conds);
         check_clause(query->tables, query->conds);
+
+        // 处理limit
+        if (x->limit && (x->limit->limit < 0 || x->limit->offset < 0))
+        {
+            throw RMDBError();
+        }
     }
     else if (auto x = std::dynamic_pointer_cast<ast::UpdateStmt>(parse))
     {
@@ -79,7 +86,7 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         for (const auto &set_clause : x->set_clauses)
         {
             // 使用局部变量来避免多次创建对象
-            SetClause update_clause(convert_sv_value(set_clause->val));
+            SetClause update_clause(convert_sv_value(set_clause->val, true));
 
             if (set_clause->self_update)
             {
@@ -93,22 +100,13 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
             // 类型转换
             auto tab = sm_manager_->db_.get_table(x->tab_name);
             auto &col = tab->get_col(set_clause->col_name);
-
-            // 如果类型不匹配，进行类型转换
-            if (col.type != update_clause.rhs.type)
+            update_clause.lhs = std::make_unique<ColMeta>(col);
+            if (update_clause.rhs.param < 0)
             {
-                if (!can_cast_type(update_clause.rhs.type, col.type))
-                {
-                    throw RMDBError();
-                }
-                else
-                {
-                    cast_value(update_clause.rhs, col.type);
-                }
+                convert_set_value(update_clause);
             }
 
             // 将更新的 SetClause 添加到 query 中
-            update_clause.lhs = std::make_unique<ColMeta>(col);
             query->set_clauses.push_back(update_clause);
         }
 
@@ -145,13 +143,32 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         // 处理insert的values值
         for (auto &sv_val : x->vals)
         {
-            query->values.push_back(convert_sv_value(sv_val));
+            query->values.push_back(convert_sv_value(sv_val, true));
         }
     }
     else
     {
         // do nothing
     }
+
+    // 预备语句的参数个数
+    auto use_param = [&](const Value &val)
+    {
+        query->param_num = std::max(query->param_num, static_cast<size_t>(val.param + 1));
+    };
+    for (const auto &cond : query->conds)
+    {
+        use_param(cond.rhs_val);
+    }
+    for (const auto &set_clause : query->set_clauses)
+    {
+        use_param(set_clause.rhs);
+    }
+    for (const auto &val : query->values)
+    {
+        use_param(val);
+    }
+
     query->parse = std::move(parse);
     return query;
 }
@@ -161,25 +178,24 @@ TabCol Analyze::check_column(const std::vector<ColMeta> &all_cols, TabCol &targe
     if (target.tab_name.empty())
     {
         // Table name not specified, infer table name from column name
-        std::string inferred_tab_name;
-        bool found = false;
+        const ColMeta *found = nullptr;
         for (const auto &col : all_cols)
         {
             if (col.name == target.col_name)
             {
-                if (found)
+                if (found != nullptr)
                 {
                     throw RMDBError();
                 }
-                inferred_tab_name = col.tab_name;
-                found = true;
+                found = &col;
             }
         }
-        if (!found)
+        if (found == nullptr)
         {
             throw RMDBError();
         }
-        target.tab_name = inferred_tab_name;
+        target.tab_name = found->tab_name;
+        target.bind(*found);
     }
     else
     {
@@ -190,6 +206,7 @@ TabCol Analyze::check_column(const std::vector<ColMeta> &all_cols, TabCol &targe
         {
             throw RMDBError();
         }
+        target.bind(*it);
     }
     return target;
 }
@@ -301,7 +318,7 @@ void Analyze::get_clause(const std::vector<std::shared_ptr<ast::BinaryExpr>> &sv
         if (auto rhs_val = std::dynamic_pointer_cast<ast::Value>(expr->rhs))
         {
             cond.is_rhs_val = true;
-            cond.rhs_val = convert_sv_value(rhs_val);
+            cond.rhs_val = convert_sv_value(rhs_val, true);
         }
         else if (auto rhs_col = std::dynamic_pointer_cast<ast::Col>(expr->rhs))
         {
@@ -333,38 +350,26 @@ void Analyze::check_clause(const std::vector<std::string> &tab_names, std::vecto
 
         // Get lhs column metadata
         auto lhs_tab = sm_manager_->db_.get_table(cond.lhs_col.tab_name);
-        auto lhs_col = lhs_tab->get_col(cond.lhs_col.col_name);
+        const auto &lhs_col = cond.lhs_col.meta(*lhs_tab);
         cond.lhs = lhs_col;
 
         ColType lhs_type = lhs_col.type;
-        ColType rhs_type;
 
         if (cond.is_rhs_val && !cond.is_subquery)
         {
-            cond.rhs_val.init_raw(lhs_col.len);
-            rhs_type = cond.rhs_val.type;
-
-            // Check if rhs_val can be cast to lhs_type
-            if (!can_cast_type(rhs_type, lhs_type))
+            if (cond.rhs_val.param < 0)
             {
-                throw RMDBError();
-            }
-
-            // Perform the cast if necessary
-            if (rhs_type != lhs_type)
-            {
-                cast_value(cond.rhs_val, lhs_type);
+                convert_cond_value(cond);
             }
         }
         else if (!cond.is_subquery)
         {
             // Get rhs column metadata
             auto rhs_tab = sm_manager_->db_.get_table(cond.rhs_col.tab_name);
-            auto rhs_col = rhs_tab->get_col(cond.rhs_col.col_name);
+            const auto &rhs_col = cond.rhs_col.meta(*rhs_tab);
             cond.rhs = rhs_col;
-            rhs_type = rhs_col.type;
 
-            if (lhs_type != rhs_type)
+            if (lhs_type != rhs_col.type)
             {
                 throw RMDBError();
             }
@@ -386,8 +391,12 @@ void Analyze::check_clause(const std::vector<std::string> &tab_names, std::vecto
                 throw RMDBError();
             }
 
-            // 4、分析子查询计划
+            // 4、分析子查询计划；子查询的计划不绑定参数，其中不能有占位符
             cond.subQuery->query = do_analyze(cond.subQuery->stmt);
+            if (cond.subQuery->query->param_num > 0)
+            {
+                throw RMDBError();
+            }
         }
         else
         {
@@ -423,6 +432,39 @@ void Analyze::check_clause(const std::vector<std::string> &tab_names, std::vecto
     return;
 }
 
+void Analyze::convert_cond_value(Condition &cond)
+{
+    cond.rhs_val.init_raw(cond.lhs.len);
+
+    // Check if rhs_val can be cast to lhs_type
+    if (!can_cast_type(cond.rhs_val.type, cond.lhs.type))
+    {
+        throw RMDBError();
+    }
+
+    // Perform the cast if necessary
+    if (cond.rhs_val.type != cond.lhs.type)
+    {
+        cast_value(cond.rhs_val, cond.lhs.type);
+    }
+}
+
+void Analyze::convert_set_value(SetClause &set_clause)
+{
+    // 如果类型不匹配，进行类型转换
+    if (set_clause.lhs->type != set_clause.rhs.type)
+    {
+        if (!can_cast_type(set_clause.rhs.type, set_clause.lhs->type))
+        {
+            throw RMDBError();
+        }
+        else
+        {
+            cast_value(set_clause.rhs, set_clause.lhs->type);
+        }
+    }
+}
+
 bool Analyze::can_cast_type(ColType from, ColType to)
 {
     // Add logic to determine if a type can be cast to another type
@@ -454,10 +496,18 @@ void Analyze::cast_value(Value &val, ColType to)
     }
 }
 
-Value Analyze::convert_sv_value(const std::shared_ptr<ast::Value> &sv_val)
+Value Analyze::convert_sv_value(const std::shared_ptr<ast::Value> &sv_val, bool allow_param)
 {
     Value val;
-    if (auto int_lit = std::dynamic_pointer_cast<ast::IntLit>(sv_val))
+    if (auto param = std::dynamic_pointer_cast<ast::ParamLit>(sv_val))
+    {
+        if (!allow_param || param->idx < 1)
+        {
+            throw RMDBError();
+        }
+        val.param = param->idx - 1;
+    }
+    else if (auto int_lit = std::dynamic_pointer_cast<ast::IntLit>(sv_val))
     {
         val.set_int(int_lit->val);
     }
@@ -485,5 +535,11 @@ CompOp Analyze::convert_sv_comp_op(ast::SvCompOp op)
         {ast::SV_OP_LE, OP_LE},
         {ast::SV_OP_GE, OP_GE},
     };
-    return m.at(op);
+    // 不支持的比较（例如 IN、NOT IN 子查询）报错，不能让 std::out_of_range 使服务器退出
+    auto it = m.find(op);
+    if (it == m.end())
+    {
+        throw RMDBError();
+    }
+    return it->second;
 }
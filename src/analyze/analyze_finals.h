@@ -27,6 +27,8 @@ public:
     std::vector<Value> values;
 
     std::vector<HavingCond> having_conds;
+    // 预备语句的参数个数（最大的占位符编号）
+    size_t param_num = 0;
 
     Query() {}
 };
@@ -41,6 +43,15 @@ public:
 
     std::shared_ptr<Query> do_analyze(std::shared_ptr<ast::TreeNode> root);
 
+    // allow_param 为 true 时常量可以是预备语句的占位符，只出现在 WHERE 条件的右边、SET 和 VALUES 中
+    static Value convert_sv_value(const std::shared_ptr<ast::Value> &sv_val, bool allow_param = false);
+
+    // 条件右边的常量转换为左边列的类型并生成 raw；占位符在 EXECUTE 绑定参数后再转换
+    static void convert_cond_value(Condition &cond);
+
+    // SET 的常量转换为列的类型
+    static void convert_set_value(SetClause &set_clause);
+
 private:
     static TabCol check_column(const std::vector<ColMeta> &all_cols, TabCol &target);
 
@@ -50,8 +61,6 @@ private:
 
     void check_clause(const std::vector<std::string> &tab_names, std::vector<Condition> &conds);
 
-    Value convert_sv_value(const std::shared_ptr<ast::Value> &sv_val);
-
     CompOp convert_sv_comp_op(ast::SvCompOp op);
 
     static bool can_cast_type(ColType from, ColType to);
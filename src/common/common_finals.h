@@ -23,6 +23,30 @@ struct TabCol
 
     ast::AggFuncType aggFuncType;
 
+    // Analyze 解析出的字段：表编号（ColMeta::tab_id）和列在表中的序号（ColMeta::idx），之后按编号匹配字段而不比较名字；
+    // COUNT(*) 等不对应表中字段的列为 -1
+    int tab_id = -1;
+    int col_idx = -1;
+
+    void bind(const ColMeta &col)
+    {
+        tab_id = col.tab_id;
+        col_idx = col.idx;
+    }
+
+    // 是否引用字段 col：绑定过的列比较编号，否则比较表名和列名
+    bool refers_to(const ColMeta &col) const
+    {
+        if (col_idx >= 0)
+        {
+            return col.idx == col_idx && col.tab_id == tab_id;
+        }
+        return col.tab_name == tab_name && col.name == col_name;
+    }
+
+    // 引用的字段在表 tab 中的元数据
+    const ColMeta &meta(TabMeta &tab) const { return col_idx >= 0 ? tab.cols[col_idx] : tab.get_col(col_name); }
+
     friend bool operator<(const TabCol &x, const TabCol &y)
     {
         return std::make_pair(x.tab_name, x.col_name) < std::make_pair(y.tab_name, y.col_name);
@@ -1,9 +1,56 @@
 #pragma once
 
+#include <cstddef>
+
 static constexpr int BUFFER_LENGTH = 2048;
 
 static constexpr int INVALID_TXN_ID = -1;
 
 static constexpr int MAX_TABLE_NUMBER = 50;
 
+// 单条语句中物化算子（hash join 等）可使用的内存上限，超出后溢出到临时文件
+static constexpr size_t QUERY_MEMORY_BUDGET = 256 << 20;
+
+// 溢出文件的读写缓冲区大小
+static constexpr size_t SPILL_BUFFER_SIZE = 64 << 10;
+
+// grace hash join 每一层的分区数与最大递归深度
+static constexpr int HASH_JOIN_PARTITIONS = 32;
+
+static constexpr int HASH_JOIN_MAX_DEPTH = 3;
+
+// 表的记录数达到该值时顺序扫描（及其上的聚合）改为多线程执行
+static constexpr size_t PARALLEL_SCAN_MIN_ROWS = 64 << 10;
+
+// 并行扫描时记录数组按该记录数切分为 morsel，每个 morsel 是线程池的一个任务
+static constexpr size_t MORSEL_ROWS = 16 << 10;
+
+// 并行聚合合并阶段的分区数，必须是 2 的幂
+static constexpr size_t AGG_PARTITIONS = 16;
+
+// 排序的行数达到该值时用基数排序代替比较排序
+static constexpr size_t SORT_RADIX_MIN_ROWS = 1 << 10;
+
+// 排序的行数达到该值时分块并行排序后归并
+static constexpr size_t PARALLEL_SORT_MIN_ROWS = 64 << 10;
+
+// ORDER BY ... LIMIT 需要的记录数不超过该值时用 Top-N 堆代替完整排序
+static constexpr int TOP_N_MAX_ROWS = 64 << 10;
+
+// 区域映射（zone map）每块的记录数，块内记录的各字段最小值、最大值用于跳过不可能满足条件的块
+// 必须是 SIMD 过滤批大小（64）的倍数且整除 MORSEL_ROWS
+static constexpr size_t ZONE_MAP_ROWS = 4 << 10;
+
+// 一条语句写入 output.txt 的内容在内存中积累到该大小后写入文件
+static constexpr size_t OUTPUT_FLUSH_SIZE = 64 << 10;
+
+// output.txt 写入队列中未写入的字节数上限，超过后写入的连接等待
+static constexpr size_t OUTPUT_QUEUE_LIMIT = 64 << 20;
+
+// 工作线程每次从连接读取的最大字节数
+static constexpr size_t RECV_BUFFER_SIZE = 64 << 10;
+
+// 一批语句合并的回复超过该大小时先发送给客户端
+static constexpr size_t REPLY_FLUSH_SIZE = 64 << 10;
+
 using txn_id_t = int32_t;
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
 #include <utility>
 
 #include "transaction/concurrency/lock_manager_finals.h"
@@ -12,10 +16,62 @@ public:
 
     static int MAX_OFFSET_LENGTH;
 
-    bool data_send_is_full() const { return *offset_ > MAX_OFFSET_LENGTH; }
+    // 发送缓冲区中的内容超过 MAX_OFFSET_LENGTH 时视为已满，之后的记录不再输出
+    // 流式输出时把缓冲区中的内容移到 reply_ 并尽量发给客户端再继续写入，只有连接出错才视为已满
+    bool data_send_is_full()
+    {
+        if (*offset_ <= MAX_OFFSET_LENGTH)
+        {
+            return false;
+        }
+        return !stream_ || !flush_data_send();
+    }
+
+    // 把发送缓冲区中的内容追加到之前语句的回复之后并清空缓冲区，再尽量写到连接上；
+    // 连接不阻塞，客户端读得慢时没有写出的部分留在 reply_ 中，由事件循环在连接可写时发送
+    bool flush_data_send()
+    {
+        reply_->append(data_send_, *offset_);
+        *offset_ = 0;
+        return send_some(sockfd_, *reply_);
+    }
+
+    // 把 data 尽量写到非阻塞的连接上，写出的部分从 data 中删除；连接出错时清空 data 并返回 false
+    static bool send_some(int fd, std::string &data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            auto n = write(fd, data.data() + sent, data.size() - sent);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            if (n <= 0)
+            {
+                data.clear();
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        data.erase(0, sent);
+        return true;
+    }
 
     LockManager *lock_mgr_;
     std::shared_ptr<Transaction> txn_;
     char *data_send_;
     int *offset_;
+
+    // 流式输出结果（set enable_result_stream = true 打开，只影响当前连接）：
+    // 结果分多次写入 sockfd_，以 '\0' 结尾，客户端读到 '\0' 为止；关闭时结果超出发送缓冲区的部分被截断
+    int sockfd_ = -1;
+    bool stream_ = false;
+    std::string *reply_ = nullptr; // 同一批语句中之前语句还没有发送的回复
+
+    size_t memory_budget_ = QUERY_MEMORY_BUDGET;
 };
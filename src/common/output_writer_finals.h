@@ -0,0 +1,286 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "config_finals.h"
+
+// output.txt 的后台写入线程：只有它持有文件描述符，各连接把格式化好的块放入无锁队列后立即返回
+// 队列是多生产者单消费者的栈：生产者用 CAS 压入，写入线程一次取走全部块再反转为先进先出的顺序，
+// 同一连接先放入的块先写入；连续的块用一次 writev 批量写入。
+// 队列中未写入的字节数超过 OUTPUT_QUEUE_LIMIT 时生产者等待，内存占用有上限
+class OutputWriter
+{
+public:
+    static OutputWriter &instance()
+    {
+        static OutputWriter writer;
+        return writer;
+    }
+
+    void write(std::string data)
+    {
+        if (!data.empty())
+        {
+            push(new Chunk{ChunkType::WRITE, std::move(data)});
+        }
+    }
+
+    // 打开数据库后在新的当前目录下打开（必要时创建）output.txt，之前放入的块仍写入原来的文件
+    void reopen()
+    {
+        char cwd[PATH_MAX];
+        std::string path = getcwd(cwd, sizeof(cwd)) != nullptr ? std::string(cwd) + "/output.txt" : "output.txt";
+        push(new Chunk{ChunkType::REOPEN, std::move(path)});
+    }
+
+    // 关闭数据库时关闭文件，之后的写入在写入线程当时的当前目录下重新打开
+    void close() { push(new Chunk{ChunkType::CLOSE, {}}); }
+
+    // 等待之前放入的块全部写入文件
+    void flush()
+    {
+        std::unique_lock lock(latch_);
+        size_t target = pushed_.load();
+        space_cv_.wait(lock, [&]
+                       { return written_ >= target; });
+    }
+
+private:
+    enum class ChunkType
+    {
+        WRITE,
+        REOPEN,
+        CLOSE
+    };
+
+    struct Chunk
+    {
+        ChunkType type;
+        std::string data; // WRITE 时为写入的内容，REOPEN 时为文件路径
+        Chunk *next = nullptr;
+    };
+
+    OutputWriter() : thread_([this]
+                             { run(); }) {}
+
+    // 进程退出时写完队列中剩余的块
+    ~OutputWriter()
+    {
+        {
+            std::lock_guard lock(latch_);
+            stop_ = true;
+        }
+        wake_cv_.notify_one();
+        thread_.join();
+        close_file();
+    }
+
+    void push(Chunk *chunk)
+    {
+        if (pending_bytes_.load() >= OUTPUT_QUEUE_LIMIT)
+        {
+            std::unique_lock lock(latch_);
+            space_cv_.wait(lock, [&]
+                           { return pending_bytes_.load() < OUTPUT_QUEUE_LIMIT; });
+        }
+        pending_bytes_.fetch_add(chunk->data.size());
+        chunk->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(chunk->next, chunk))
+        {
+        }
+        pushed_.fetch_add(1);
+        // 写入线程只在队列为空时睡眠，此时才需要唤醒；压入与读取 sleeping_ 都是顺序一致的，不会错过唤醒
+        if (sleeping_.load())
+        {
+            std::lock_guard lock(latch_);
+            wake_cv_.notify_one();
+        }
+    }
+
+    void run()
+    {
+        std::vector<Chunk *> chunks;
+        while (true)
+        {
+            Chunk *list = head_.exchange(nullptr, std::memory_order_acquire);
+            if (list == nullptr)
+            {
+                std::unique_lock lock(latch_);
+                if (stop_)
+                {
+                    return;
+                }
+                sleeping_.store(true);
+                wake_cv_.wait(lock, [&]
+                              { return stop_ || head_.load() != nullptr; });
+                sleeping_.store(false);
+                continue;
+            }
+            chunks.clear();
+            for (; list != nullptr; list = list->next)
+            {
+                chunks.push_back(list);
+            }
+            std::reverse(chunks.begin(), chunks.end());
+            size_t bytes = write_chunks(chunks);
+            {
+                std::lock_guard lock(latch_);
+                pending_bytes_.fetch_sub(bytes);
+                written_ += chunks.size();
+            }
+            space_cv_.notify_all();
+            for (auto chunk : chunks)
+            {
+                delete chunk;
+            }
+        }
+    }
+
+    // 按顺序处理一批块，返回 WRITE 块的总字节数
+    size_t write_chunks(const std::vector<Chunk *> &chunks)
+    {
+        size_t bytes = 0;
+        std::vector<iovec> iovs;
+        for (auto chunk : chunks)
+        {
+            if (chunk->type != ChunkType::WRITE)
+            {
+                write_iovs(iovs);
+                close_file();
+                if (chunk->type == ChunkType::REOPEN)
+                {
+                    fd_ = open(chunk->data.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+                }
+                continue;
+            }
+            bytes += chunk->data.size();
+            iovs.push_back({chunk->data.data(), chunk->data.size()});
+        }
+        write_iovs(iovs);
+        return bytes;
+    }
+
+    void write_iovs(std::vector<iovec> &iovs)
+    {
+        if (iovs.empty())
+        {
+            return;
+        }
+        if (fd_ < 0)
+        {
+            fd_ = open("output.txt", O_WRONLY | O_APPEND | O_CREAT, 0644);
+        }
+        size_t begin = 0;
+        while (begin < iovs.size() && fd_ >= 0)
+        {
+            int cnt = static_cast<int>(std::min<size_t>(IOV_MAX, iovs.size() - begin));
+            auto n = writev(fd_, iovs.data() + begin, cnt);
+            if (n <= 0)
+            {
+                break;
+            }
+            // 跳过已经写完的部分，部分写入的 iovec 调整起点
+            for (auto left = static_cast<size_t>(n); left > 0 && begin < iovs.size(); begin++)
+            {
+                if (left < iovs[begin].iov_len)
+                {
+                    iovs[begin].iov_base = static_cast<char *>(iovs[begin].iov_base) + left;
+                    iovs[begin].iov_len -= left;
+                    break;
+                }
+                left -= iovs[begin].iov_len;
+            }
+        }
+        iovs.clear();
+    }
+
+    void close_file()
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    std::atomic<Chunk *> head_{nullptr};
+    std::atomic<size_t> pending_bytes_{0}; // 已放入队列、尚未写入的字节数
+    std::atomic<size_t> pushed_{0};        // 放入队列的块数
+    size_t written_ = 0;                   // 已处理的块数，受 latch_ 保护
+    std::atomic<bool> sleeping_{false};
+    bool stop_ = false;
+    int fd_ = -1; // 只由写入线程访问
+    std::mutex latch_;
+    std::condition_variable wake_cv_;  // 唤醒写入线程
+    std::condition_variable space_cv_; // 队列有空间或有块写完时唤醒生产者
+    std::thread thread_;
+};
+
+// 一条语句写入 output.txt 的内容，先积累在内存中，超过 OUTPUT_FLUSH_SIZE 或析构时整块放入 OutputWriter 的队列
+// enabled 为 false（io 关闭）时丢弃所有内容
+class OutputBuffer
+{
+public:
+    explicit OutputBuffer(bool enabled) : enabled_(enabled) {}
+
+    OutputBuffer(const OutputBuffer &) = delete;
+
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    ~OutputBuffer() { flush(); }
+
+    bool enabled() const { return enabled_; }
+
+    OutputBuffer &append(std::string_view str)
+    {
+        if (enabled_)
+        {
+            buf_.append(str);
+        }
+        return *this;
+    }
+
+    OutputBuffer &append(char c)
+    {
+        if (enabled_)
+        {
+            buf_.push_back(c);
+        }
+        return *this;
+    }
+
+    // 一行结束，缓冲的内容足够多时写入文件
+    void end_line()
+    {
+        append('\n');
+        if (buf_.size() >= OUTPUT_FLUSH_SIZE)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (!buf_.empty())
+        {
+            OutputWriter::instance().write(std::move(buf_));
+            buf_.clear();
+        }
+    }
+
+private:
+    bool enabled_;
+    std::string buf_;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RMDB_SIMD_FILTER_X86
+#endif
+
+// INT/FLOAT 字段的范围过滤：对一批记录（最多 SIMD_FILTER_BATCH 条）中某个字段的值，
+// 计算 lower (< 或 <=) v (< 或 <=) upper，第 i 个值满足时结果的第 i 位为 1。
+// 值由调用者从各行拷贝成连续的数组（列式），CPU 支持 AVX2 时每次比较 8 个值，否则逐个比较
+namespace simd_filter
+{
+    static constexpr size_t SIMD_FILTER_BATCH = 64;
+
+    template <typename T>
+    inline uint64_t range_mask_scalar(const T *values, size_t n, T lower, T upper, bool lower_closed, bool upper_closed)
+    {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            T v = values[i];
+            bool ok = (lower_closed ? v >= lower : v > lower) && (upper_closed ? v <= upper : v < upper);
+            mask |= static_cast<uint64_t>(ok) << i;
+        }
+        return mask;
+    }
+
+#ifdef RMDB_SIMD_FILTER_X86
+    // 闭区间的一端用“严格比较 或 (相等 且 闭区间)”表示，循环内没有分支
+    __attribute__((target("avx2"))) inline uint64_t range_mask_avx2(const int *values, size_t n, int lower, int upper, bool lower_closed, bool upper_closed)
+    {
+        const __m256i low = _mm256_set1_epi32(lower);
+        const __m256i up = _mm256_set1_epi32(upper);
+        const __m256i low_closed = _mm256_set1_epi32(lower_closed ? -1 : 0);
+        const __m256i up_closed = _mm256_set1_epi32(upper_closed ? -1 : 0);
+        uint64_t mask = 0;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+            __m256i low_ok = _mm256_or_si256(_mm256_cmpgt_epi32(v, low), _mm256_and_si256(_mm256_cmpeq_epi32(v, low), low_closed));
+            __m256i up_ok = _mm256_or_si256(_mm256_cmpgt_epi32(up, v), _mm256_and_si256(_mm256_cmpeq_epi32(v, up), up_closed));
+            auto bits = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(low_ok, up_ok))));
+            mask |= static_cast<uint64_t>(bits) << i;
+        }
+        return i < n ? mask | range_mask_scalar(values + i, n - i, lower, upper, lower_closed, upper_closed) << i : mask;
+    }
+
+    __attribute__((target("avx2"))) inline uint64_t range_mask_avx2(const float *values, size_t n, float lower, float upper, bool lower_closed, bool upper_closed)
+    {
+        const __m256 low = _mm256_set1_ps(lower);
+        const __m256 up = _mm256_set1_ps(upper);
+        const __m256 low_closed = _mm256_castsi256_ps(_mm256_set1_epi32(lower_closed ? -1 : 0));
+        const __m256 up_closed = _mm256_castsi256_ps(_mm256_set1_epi32(upper_closed ? -1 : 0));
+        uint64_t mask = 0;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 v = _mm256_loadu_ps(values + i);
+            __m256 low_ok = _mm256_or_ps(_mm256_cmp_ps(v, low, _CMP_GT_OQ), _mm256_and_ps(_mm256_cmp_ps(v, low, _CMP_EQ_OQ), low_closed));
+            __m256 up_ok = _mm256_or_ps(_mm256_cmp_ps(v, up, _CMP_LT_OQ), _mm256_and_ps(_mm256_cmp_ps(v, up, _CMP_EQ_OQ), up_closed));
+            auto bits = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(low_ok, up_ok)));
+            mask |= static_cast<uint64_t>(bits) << i;
+        }
+        return i < n ? mask | range_mask_scalar(values + i, n - i, lower, upper, lower_closed, upper_closed) << i : mask;
+    }
+#endif
+
+    // 是否使用 AVX2，默认按 CPU 是否支持决定；测试与基准程序可以关闭以比较两种实现
+    inline bool &avx2_enabled()
+    {
+#ifdef RMDB_SIMD_FILTER_X86
+        static bool enabled = __builtin_cpu_supports("avx2");
+#else
+        static bool enabled = false;
+#endif
+        return enabled;
+    }
+
+    template <typename T>
+    inline uint64_t range_mask(const T *values, size_t n, T lower, T upper, bool lower_closed, bool upper_closed)
+    {
+#ifdef RMDB_SIMD_FILTER_X86
+        if (avx2_enabled())
+        {
+            return range_mask_avx2(values, n, lower, upper, lower_closed, upper_closed);
+        }
+#endif
+        return range_mask_scalar(values, n, lower, upper, lower_closed, upper_closed);
+    }
+} // namespace simd_filter
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+// 语句级的内存池：一条语句的语法树、Query 和 Plan 从中顺序分配，释放时什么也不做，语句结束后整体重置。
+// 每个工作线程持有一个，执行语句时通过 Scope 设为当前线程的内存池；没有设置时 arena_make_shared 退化为 std::make_shared
+class StatementArena
+{
+public:
+    // 语句执行期间的作用域：构造时设为当前内存池，析构时重置内存池并恢复之前的设置。
+    // arena 为 nullptr 时在作用域内改为从堆上分配，用于需要在语句结束后保留的对象（如预备语句的语法树和计划）
+    class Scope
+    {
+    public:
+        explicit Scope(StatementArena *arena) : arena_(arena), prev_(current_) { current_ = arena; }
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope()
+        {
+            if (arena_ != nullptr)
+            {
+                arena_->resource_.release();
+            }
+            current_ = prev_;
+        }
+
+    private:
+        StatementArena *arena_;
+        StatementArena *prev_;
+    };
+
+    StatementArena() = default;
+
+    StatementArena(const StatementArena &) = delete;
+
+    StatementArena &operator=(const StatementArena &) = delete;
+
+    // 对象和 shared_ptr 的控制块在同一次分配中得到
+    template <typename T, typename... Args>
+    static std::shared_ptr<T> make_shared(Args &&...args)
+    {
+        if (current_ == nullptr)
+        {
+            return std::make_shared<T>(std::forward<Args>(args)...);
+        }
+        return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(&current_->resource_), std::forward<Args>(args)...);
+    }
+
+private:
+    // 短语句只使用内置的缓冲区，长语句用完后向堆申请更大的块，重置时归还
+    static constexpr size_t INITIAL_SIZE = 16 * 1024;
+
+    static inline thread_local StatementArena *current_ = nullptr;
+
+    alignas(std::max_align_t) char buffer_[INITIAL_SIZE];
+    std::pmr::monotonic_buffer_resource resource_{buffer_, INITIAL_SIZE};
+};
+
+template <typename T, typename... Args>
+std::shared_ptr<T> arena_make_shared(Args &&...args)
+{
+    return StatementArena::make_shared<T>(std::forward<Args>(args)...);
+}
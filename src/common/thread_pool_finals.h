@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 查询内并行使用的全局线程池
+// 调用 parallel_for 的线程也参与执行自己提交的任务，多个连接可以同时提交任务。
+// 任务（例如扫描的一个 morsel）按编号连续地预先分给每个线程，线程先从前往后执行自己的任务，
+// 做完后从其他线程的任务末尾窃取，忙于其他查询或执行较慢的线程不会拖慢整个 job
+class ThreadPool
+{
+public:
+    static ThreadPool &instance()
+    {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    // 参与执行一次 parallel_for 的线程数（含调用线程）
+    size_t worker_num() const { return workers_.size() + 1; }
+
+    // 执行 task_num 个任务，fn(task, worker) 中 worker 为 [0, worker_num()) 内的线程编号，调用线程编号为 0
+    // 同一个 worker 编号的任务不会并发执行，可以用它索引线程局部的状态；返回时所有任务都已完成
+    // 同一线程执行的任务编号不保证递增（窃取来的任务可能更靠前）
+    void parallel_for(size_t task_num, const std::function<void(size_t, size_t)> &fn)
+    {
+        if (task_num == 0)
+        {
+            return;
+        }
+        auto job = std::make_shared<Job>(task_num, worker_num());
+        job->fn = &fn;
+        if (task_num > 1 && !workers_.empty())
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(job);
+            cv_.notify_all();
+        }
+        run(*job, 0);
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->cv.wait(lock, [&]
+                     { return job->done == job->task_num; });
+        if (job->error)
+        {
+            std::rethrow_exception(job->error);
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            cv_.notify_all();
+        }
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+private:
+    static constexpr size_t NONE = SIZE_MAX;
+
+    // 一个线程尚未执行的任务 [begin, end)
+    struct TaskRange
+    {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    struct Job
+    {
+        Job(size_t task_num, size_t worker_num) : task_num(task_num), ranges(worker_num)
+        {
+            for (size_t i = 0; i < worker_num; i++)
+            {
+                ranges[i].begin = task_num * i / worker_num;
+                ranges[i].end = task_num * (i + 1) / worker_num;
+            }
+        }
+
+        // 先取自己的任务，没有了再从其他线程的任务末尾窃取
+        size_t claim(size_t worker)
+        {
+            for (size_t i = 0; i < ranges.size(); i++)
+            {
+                auto &range = ranges[(worker + i) % ranges.size()];
+                std::lock_guard<std::mutex> lock(range.mutex);
+                if (range.begin < range.end)
+                {
+                    claimed.fetch_add(1);
+                    return i == 0 ? range.begin++ : --range.end;
+                }
+            }
+            return NONE;
+        }
+
+        size_t task_num;
+        std::vector<TaskRange> ranges;
+        const std::function<void(size_t, size_t)> *fn = nullptr;
+        std::atomic<size_t> claimed{0};
+        size_t done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    explicit ThreadPool(size_t thread_num)
+    {
+        for (size_t i = 0; i < thread_num; i++)
+        {
+            workers_.emplace_back([this, i]
+                                  { work(i + 1); });
+        }
+    }
+
+    // 不断领取任务直到任务领完
+    static void run(Job &job, size_t worker)
+    {
+        size_t finished = 0;
+        std::exception_ptr error;
+        for (size_t task; (task = job.claim(worker)) != NONE; finished++)
+        {
+            try
+            {
+                (*job.fn)(task, worker);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        }
+        if (finished == 0)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(job.mutex);
+        if (error && !job.error)
+        {
+            job.error = error;
+        }
+        job.done += finished;
+        if (job.done == job.task_num)
+        {
+            job.cv.notify_all();
+        }
+    }
+
+    void work(size_t worker)
+    {
+        while (true)
+        {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&]
+                         { return stop_ || !jobs_.empty(); });
+                if (stop_)
+                {
+                    return;
+                }
+                job = jobs_.front();
+                // 任务已经领完的 job 从队列中移除
+                if (job->claimed.load() >= job->task_num)
+                {
+                    jobs_.pop_front();
+                    continue;
+                }
+            }
+            run(*job, worker);
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::deque<std::shared_ptr<Job>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
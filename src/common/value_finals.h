@@ -115,6 +115,8 @@ struct Value
 
     std::shared_ptr<RmRecord> raw; 
 
+    int param = -1; // 预备语句中占位符的编号（从 0 开始），EXECUTE 时绑定参数；-1 表示常量
+
     
     void set_int(int int_val_)
     {
@@ -281,7 +283,8 @@ struct ColMeta
     int len{};                      
     int offset{};                   
     bool index{};                   
-    int idx;                        
+    int idx = -1;                   
+    int tab_id = -1; // 所属表的编号（TabMeta::fd_），加入表时设置；与 idx 一起唯一确定一个字段
 
     ColMeta() = default;
 
@@ -353,7 +356,8 @@ struct TabMeta
     void push_back(const ColMeta &col)
     {
         cols.push_back(col);
-        cols_idx_[col.name] = col;
+        cols.back().tab_id = fd_;
+        cols_idx_[col.name] = cols.back();
         col_tot_len += col.len;
     }
 
@@ -394,6 +398,7 @@ class DbMeta
 public:
     std::string name_;                                               
     std::unordered_map<std::string, std::unique_ptr<TabMeta>> tabs_; 
+    std::atomic<uint64_t> version_{0}; // 建删表或索引后加一，缓存的预备语句计划据此失效
 
     bool is_table(const std::string &tab_name) const
     {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 class RMDBError : public std::exception
 {
 };
@@ -11,3 +13,14 @@ class IndexEntryAlreadyExistError : public RMDBError
 class TransactionAbortException : public RMDBError
 {
 };
+
+// 加锁时与较新的事务冲突，按 wait-die 较老的事务应等待：撤销当前语句的修改，在表 fd 上有锁释放后重新执行。
+// epoch 是发现冲突时的 LockManager::release_epoch(fd)，之后已变化说明在此期间这张表上有锁释放，应立即重新执行
+class TransactionWaitException : public TransactionAbortException
+{
+public:
+    TransactionWaitException(int fd, uint64_t epoch) : fd_(fd), epoch_(epoch) {}
+
+    int fd_;
+    uint64_t epoch_;
+};
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "common/common_finals.h"
+
+// 聚合列的累加器更新函数，初始化时按聚合函数和字段类型选定，逐行更新时不再判断类型
+// init 用分组内第一条记录初始化累加器，update 用之后的记录更新累加器，
+// merge 把另一个部分聚合结果合并进来（并行聚合），other_first 表示另一个部分结果中的分组出现得更早
+struct AggFuncImpl
+{
+    void (*init)(char *slot, const char *value, int len);
+    void (*update)(char *slot, const char *value, int len);
+    void (*merge)(char *slot, const char *other, int len, bool other_first);
+};
+
+// 定长字符串字段，按字节序比较
+struct FixedString
+{
+};
+
+template <typename T>
+struct AggSum
+{
+    static void init(char *slot, const char *value, int len)
+    {
+        T acc = 0;
+        memcpy(slot, &acc, sizeof(T));
+        update(slot, value, len);
+    }
+
+    static void update(char *slot, const char *value, int)
+    {
+        T acc, v;
+        memcpy(&acc, slot, sizeof(T));
+        memcpy(&v, value, sizeof(T));
+        acc += v;
+        memcpy(slot, &acc, sizeof(T));
+    }
+
+    static void merge(char *slot, const char *other, int len, bool) { update(slot, other, len); }
+};
+
+template <typename T>
+struct AggMin
+{
+    static void init(char *slot, const char *value, int len) { memcpy(slot, value, sizeof(T)); }
+
+    static void update(char *slot, const char *value, int)
+    {
+        T acc, v;
+        memcpy(&acc, slot, sizeof(T));
+        memcpy(&v, value, sizeof(T));
+        if (v < acc)
+        {
+            memcpy(slot, &v, sizeof(T));
+        }
+    }
+
+    static void merge(char *slot, const char *other, int len, bool) { update(slot, other, len); }
+};
+
+template <>
+struct AggMin<FixedString>
+{
+    static void init(char *slot, const char *value, int len) { memcpy(slot, value, len); }
+
+    static void update(char *slot, const char *value, int len)
+    {
+        if (memcmp(value, slot, len) < 0)
+        {
+            memcpy(slot, value, len);
+        }
+    }
+
+    static void merge(char *slot, const char *other, int len, bool) { update(slot, other, len); }
+};
+
+template <typename T>
+struct AggMax
+{
+    static void init(char *slot, const char *value, int len) { memcpy(slot, value, sizeof(T)); }
+
+    static void update(char *slot, const char *value, int)
+    {
+        T acc, v;
+        memcpy(&acc, slot, sizeof(T));
+        memcpy(&v, value, sizeof(T));
+        if (acc < v)
+        {
+            memcpy(slot, &v, sizeof(T));
+        }
+    }
+
+    static void merge(char *slot, const char *other, int len, bool) { update(slot, other, len); }
+};
+
+template <>
+struct AggMax<FixedString>
+{
+    static void init(char *slot, const char *value, int len) { memcpy(slot, value, len); }
+
+    static void update(char *slot, const char *value, int len)
+    {
+        if (memcmp(slot, value, len) < 0)
+        {
+            memcpy(slot, value, len);
+        }
+    }
+
+    static void merge(char *slot, const char *other, int len, bool) { update(slot, other, len); }
+};
+
+struct AggCount
+{
+    static void init(char *slot, const char *, int)
+    {
+        int count = 1;
+        memcpy(slot, &count, sizeof(int));
+    }
+
+    static void update(char *slot, const char *, int)
+    {
+        int count;
+        memcpy(&count, slot, sizeof(int));
+        count++;
+        memcpy(slot, &count, sizeof(int));
+    }
+
+    static void merge(char *slot, const char *other, int, bool)
+    {
+        int count, other_count;
+        memcpy(&count, slot, sizeof(int));
+        memcpy(&other_count, other, sizeof(int));
+        count += other_count;
+        memcpy(slot, &count, sizeof(int));
+    }
+};
+
+// 被 group by 的非聚合列，保留分组内第一条记录的值
+struct AggFirst
+{
+    static void init(char *slot, const char *value, int len) { memcpy(slot, value, len); }
+
+    static void update(char *, const char *, int) {}
+
+    static void merge(char *slot, const char *other, int len, bool other_first)
+    {
+        if (other_first)
+        {
+            memcpy(slot, other, len);
+        }
+    }
+};
+
+template <typename F>
+constexpr AggFuncImpl agg_func_impl() { return {&F::init, &F::update, &F::merge}; }
+
+inline AggFuncImpl get_agg_func_impl(ast::AggFuncType agg_type, ColType type)
+{
+    switch (agg_type)
+    {
+    case ast::COUNT:
+        return agg_func_impl<AggCount>();
+    case ast::SUM:
+        if (type == TYPE_INT)
+            return agg_func_impl<AggSum<int>>();
+        if (type == TYPE_FLOAT)
+            return agg_func_impl<AggSum<float>>();
+        break;
+    case ast::MIN:
+        if (type == TYPE_INT)
+            return agg_func_impl<AggMin<int>>();
+        if (type == TYPE_FLOAT)
+            return agg_func_impl<AggMin<float>>();
+        return agg_func_impl<AggMin<FixedString>>();
+    case ast::MAX:
+        if (type == TYPE_INT)
+            return agg_func_impl<AggMax<int>>();
+        if (type == TYPE_FLOAT)
+            return agg_func_impl<AggMax<float>>();
+        return agg_func_impl<AggMax<FixedString>>();
+    case ast::default_type:
+        return agg_func_impl<AggFirst>();
+    default:
+        break;
+    }
+    throw RMDBError();
+}
+
+// 聚合用的 hash 表
+// 分组键是 group by 字段拼接成的定长字节串，每个分组占一段连续内存：[分组键 | 累加器]，
+// 分组按第一次出现的顺序存放，桶数组用开放寻址（线性探测）保存分组编号和 hash 值
+class AggHashTable
+{
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    AggHashTable(size_t key_len, size_t acc_len) : key_len_(key_len), entry_len_(key_len + acc_len)
+    {
+        buckets_.assign(16, {NONE, 0});
+    }
+
+    size_t size() const { return group_num_; }
+
+    // 查找分组，不存在时插入，inserted 返回是否为新分组；返回分组编号
+    uint32_t find_or_insert(const char *key, bool &inserted) { return find_or_insert(key, hash_key(key), inserted); }
+
+    uint32_t find_or_insert(const char *key, uint64_t hash, bool &inserted)
+    {
+        size_t mask = buckets_.size() - 1;
+        for (size_t pos = hash & mask;; pos = (pos + 1) & mask)
+        {
+            auto &bucket = buckets_[pos];
+            if (bucket.group == NONE)
+            {
+                inserted = true;
+                auto group = static_cast<uint32_t>(group_num_);
+                bucket = {group, hash};
+                hashes_.push_back(hash);
+                append_entry(key);
+                if (group_num_ * 2 > buckets_.size())
+                {
+                    grow();
+                }
+                return group;
+            }
+            if (bucket.hash == hash && memcmp(this->key(bucket.group), key, key_len_) == 0)
+            {
+                inserted = false;
+                return bucket.group;
+            }
+        }
+    }
+
+    // 第 idx 个分组（按第一次出现的顺序）的分组键、hash 值与累加器
+    const char *key(size_t idx) const { return entries_.data() + idx * entry_len_; }
+
+    uint64_t hash(size_t idx) const { return hashes_[idx]; }
+
+    const char *accumulator(size_t idx) const { return entries_.data() + idx * entry_len_ + key_len_; }
+
+    char *accumulator(size_t idx) { return entries_.data() + idx * entry_len_ + key_len_; }
+
+    uint64_t hash_key(const char *key) const
+    {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (size_t i = 0; i < key_len_; i++)
+        {
+            h = (h ^ static_cast<unsigned char>(key[i])) * 0x100000001b3ULL;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+private:
+    struct Bucket
+    {
+        uint32_t group;
+        uint64_t hash;
+    };
+
+    void append_entry(const char *key)
+    {
+        entries_.resize(entries_.size() + entry_len_);
+        memcpy(entries_.data() + group_num_ * entry_len_, key, key_len_);
+        group_num_++;
+    }
+
+    void grow()
+    {
+        std::vector<Bucket> buckets(buckets_.size() * 2, {NONE, 0});
+        size_t mask = buckets.size() - 1;
+        for (const auto &bucket : buckets_)
+        {
+            if (bucket.group == NONE)
+            {
+                continue;
+            }
+            size_t pos = bucket.hash & mask;
+            while (buckets[pos].group != NONE)
+            {
+                pos = (pos + 1) & mask;
+            }
+            buckets[pos] = bucket;
+        }
+        buckets_ = std::move(buckets);
+    }
+
+    size_t key_len_;
+    size_t entry_len_;
+    size_t group_num_ = 0;
+    std::vector<char> entries_;
+    std::vector<uint64_t> hashes_;
+    std::vector<Bucket> buckets_;
+};
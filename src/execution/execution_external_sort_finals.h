@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "common/context_finals.h"
+#include "execution_sort_key_finals.h"
+#include "storage/spill_file_finals.h"
+
+// 外部排序：记录连同规范化键缓存在内存中，超出语句的内存预算时把当前批次排好序写成一个临时文件（run），
+// 所有记录加入后若有 run，用败者树对各个 run 做 k 路归并；每个 run 通过 SpillFile 的缓冲区成块预读。
+// 键相同的记录保持加入的顺序。SortExecutor（包括 sort merge join 两侧的排序）都通过它排序
+class ExternalSorter
+{
+public:
+    ExternalSorter(SortKeyEncoder encoder, size_t row_len, Context *context)
+        : encoder_(std::move(encoder)), key_len_(encoder_.key_len()), row_len_(row_len), context_(context) {}
+
+    void add(const char *row)
+    {
+        rows_.insert(rows_.end(), row, row + row_len_);
+        keys_.resize(keys_.size() + key_len_);
+        encoder_.encode(row, keys_.data() + keys_.size() - key_len_);
+        if (rows_.size() + keys_.size() > context_->memory_budget_)
+        {
+            spill_run();
+        }
+    }
+
+    // 所有记录加入后调用，之后可以按顺序读取
+    void finish()
+    {
+        if (runs_.empty())
+        {
+            order_ = NormalizedKeySorter(keys_.data(), key_len_).sort(row_num());
+        }
+        else
+        {
+            if (row_num() > 0)
+            {
+                spill_run();
+            }
+            cursors_.resize(runs_.size());
+            for (auto &cursor : cursors_)
+            {
+                cursor.entry.resize(key_len_ + row_len_);
+            }
+        }
+        rewind();
+    }
+
+    // 是否使用了临时文件；此时 row() 返回的内存在 next() 之后会被覆盖
+    bool spilled() const { return !runs_.empty(); }
+
+    void rewind()
+    {
+        pos_ = 0;
+        if (!spilled())
+        {
+            return;
+        }
+        for (size_t i = 0; i < runs_.size(); i++)
+        {
+            runs_[i]->rewind();
+            cursors_[i].is_end = !runs_[i]->read(cursors_[i].entry.data(), key_len_ + row_len_);
+        }
+        build_tree();
+    }
+
+    bool is_end() const
+    {
+        return spilled() ? cursors_[tree_[0]].is_end : pos_ >= order_.size();
+    }
+
+    char *row()
+    {
+        return spilled() ? cursors_[tree_[0]].entry.data() + key_len_ : rows_.data() + order_[pos_] * row_len_;
+    }
+
+    void next()
+    {
+        if (!spilled())
+        {
+            pos_++;
+            return;
+        }
+        size_t winner = tree_[0];
+        cursors_[winner].is_end = !runs_[winner]->read(cursors_[winner].entry.data(), key_len_ + row_len_);
+        adjust(winner);
+    }
+
+private:
+    // run 的读取位置，entry 为当前的 [规范化键 | 记录]
+    struct RunCursor
+    {
+        std::vector<char> entry;
+        bool is_end = true;
+    };
+
+    size_t row_num() const { return rows_.size() / row_len_; }
+
+    void spill_run()
+    {
+        auto order = NormalizedKeySorter(keys_.data(), key_len_).sort(row_num());
+        auto run = std::make_unique<SpillFile>();
+        for (auto row : order)
+        {
+            run->append(keys_.data() + row * key_len_, key_len_);
+            run->append(rows_.data() + row * row_len_, row_len_);
+        }
+        runs_.push_back(std::move(run));
+        std::vector<char>().swap(rows_);
+        std::vector<char>().swap(keys_);
+    }
+
+    // run a 的当前记录是否排在 run b 之前：读完的 run 排在最后，键相同时先生成的 run 在前
+    bool beats(size_t a, size_t b) const
+    {
+        if (cursors_[a].is_end || cursors_[b].is_end)
+        {
+            return !cursors_[a].is_end && cursors_[b].is_end;
+        }
+        int res = memcmp(cursors_[a].entry.data(), cursors_[b].entry.data(), key_len_);
+        return res < 0 || (res == 0 && a < b);
+    }
+
+    // 败者树：k 个 run 是下标为 [k, 2k) 的叶子，tree_[1..k) 保存各场比赛的败者，tree_[0] 保存最终胜者
+    void build_tree()
+    {
+        size_t k = runs_.size();
+        std::vector<size_t> winners(2 * k);
+        tree_.assign(k, 0);
+        for (size_t i = 0; i < k; i++)
+        {
+            winners[k + i] = i;
+        }
+        for (size_t node = k - 1; node > 0; node--)
+        {
+            size_t a = winners[2 * node];
+            size_t b = winners[2 * node + 1];
+            winners[node] = beats(a, b) ? a : b;
+            tree_[node] = beats(a, b) ? b : a;
+        }
+        tree_[0] = k > 1 ? winners[1] : 0;
+    }
+
+    // run 的当前记录变化后，沿叶子到根的路径与各层的败者重新比较
+    void adjust(size_t run)
+    {
+        size_t winner = run;
+        for (size_t node = (run + runs_.size()) / 2; node > 0; node /= 2)
+        {
+            if (beats(tree_[node], winner))
+            {
+                std::swap(tree_[node], winner);
+            }
+        }
+        tree_[0] = winner;
+    }
+
+    SortKeyEncoder encoder_;
+    size_t key_len_;
+    size_t row_len_;
+    Context *context_;
+
+    // 当前批次的记录与规范化键
+    std::vector<char> rows_;
+    std::vector<char> keys_;
+    std::vector<uint32_t> order_; // 未溢出时的排序结果
+    size_t pos_ = 0;
+
+    std::vector<std::unique_ptr<SpillFile>> runs_;
+    std::vector<RunCursor> cursors_;
+    std::vector<size_t> tree_;
+};
@@ -8,7 +8,10 @@
 #include <climits>
 #include <unordered_map>
 
+#include "common/thread_pool_finals.h"
+#include "execution_agg_hash_table_finals.h"
 #include "executor_abstract_finals.h"
+#include "executor_seq_scan_finals.h"
 
 class AggPlanExecutor : public AbstractExecutor
 {
@@ -22,8 +25,17 @@ private:
     std::unique_ptr<AbstractExecutor> child_executor_;
     std::vector<ColMeta> output_cols_; // 输出列的元数据
 
-    std::vector<std::string> insert_order_; // 保证顺序的一致性
-    std::unordered_map<std::string, std::vector<Value>> group_map_;
+    // 每个输出列的累加器：在输入记录中的偏移、在累加器中的偏移（与输出记录相同）、长度与更新函数
+    struct AggColumn
+    {
+        int input_offset;
+        int slot_offset;
+        int len;
+        AggFuncImpl impl;
+    };
+    std::vector<AggColumn> agg_columns_;
+    size_t key_len_ = 0;
+    bool can_parallel_ = true; // 浮点数 SUM 的结果依赖累加顺序，为保证结果与串行一致不并行
 
     std::vector<RmRecord> results_;
     std::vector<RmRecord>::iterator result_it_;
@@ -43,7 +55,6 @@ public:
 
     void beginTuple() override
     {
-        child_executor_->beginTuple();
         performAggregation();
         result_it_ = results_.begin();
     }
@@ -77,7 +88,10 @@ private:
         {
             if (col.aggFuncType == ast::COUNT)
             {
-                ColMeta col_meta(col.tab_name, col.col_name, TYPE_INT, col.aggFuncType, sizeof(int), TupleLen, false);
+                // 与被计数的列编号相同，上层按编号找到这一列
+                ColMeta col_meta(col.tab_name, col.col_name, TYPE_INT, col.aggFuncType, sizeof(int), TupleLen, false, col.col_idx);
+                col_meta.tab_id = col.tab_id;
+                agg_columns_.push_back({0, TupleLen, col_meta.len, get_agg_func_impl(ast::COUNT, TYPE_INT)});
                 TupleLen += col_meta.len;
                 output_cols_.push_back(col_meta);
                 // 往sel_col_metas_随便push一个
@@ -95,6 +109,11 @@ private:
 
                 auto col_meta = *temp;
                 col_meta.offset = TupleLen;
+                agg_columns_.push_back({temp->offset, TupleLen, col_meta.len, get_agg_func_impl(col.aggFuncType, col_meta.type)});
+                if (col.aggFuncType == ast::SUM && col_meta.type == TYPE_FLOAT)
+                {
+                    can_parallel_ = false;
+                }
                 TupleLen += col_meta.len;
                 col_meta.agg_func_type = col.aggFuncType;
                 output_cols_.push_back(col_meta);
@@ -105,12 +124,26 @@ private:
         {
             auto col_meta = get_col(child_executor_->cols(), col);
             group_by_col_metas_.push_back(col_meta);
+            key_len_ += col_meta->len;
         }
     }
 
     // Perform aggregation on the child executor
     void performAggregation()
     {
+        // 输入是足够大的单表顺序扫描时，由扫描的各个线程直接做局部聚合
+        auto seq_scan = dynamic_cast<SeqScanExecutor *>(child_executor_.get());
+        if (can_parallel_ && seq_scan != nullptr && seq_scan->can_parallel_scan())
+        {
+            parallelAggregation(*seq_scan);
+            return;
+        }
+
+        // 并行聚合直接扫描记录数组，只有串行聚合需要初始化儿子，否则顺序扫描会先并行过滤一遍整张表
+        child_executor_->beginTuple();
+        // 累加器与输出记录的布局相同，聚合结束后直接拷贝为结果
+        AggHashTable table(key_len_, TupleLen);
+        std::vector<char> key(key_len_);
         while (!child_executor_->is_end())
         {
             std::unique_ptr<RmRecord> record = child_executor_->Next();
@@ -120,189 +153,137 @@ private:
                 break;
             }
 
-            std::string key = generateGroupByKey(*record);
-            aggregateValues(key, *record);
-        }
-        generateResults();
-    }
-
-    inline std::string generateGroupByKey(const RmRecord &record)
-    {
-        if (group_by_cols_.empty())
-        {
-            return "__no_group_by__";
+            generateGroupByKey(record->data, key.data());
+            bool inserted;
+            auto group = table.find_or_insert(key.data(), inserted);
+            aggregateRow(table.accumulator(group), record->data, inserted);
         }
-
-        std::string key;
-        for (const auto &col_meta : group_by_col_metas_)
+        std::vector<const char *> groups(table.size());
+        for (size_t i = 0; i < table.size(); i++)
         {
-            key.append(record.data + col_meta->offset, col_meta->len);
+            groups[i] = table.accumulator(i);
         }
-        return key;
+        generateResults(groups);
     }
 
-    void aggregateValues(const std::string &key, const RmRecord &record)
+    // 两阶段并行聚合：扫描线程把满足条件的记录聚合到线程局部、按分组键 hash 分区的表中，
+    // 之后每个分区由一个任务把所有线程的局部结果合并。分组按第一次出现的记录下标排序，输出顺序与串行相同
+    void parallelAggregation(const SeqScanExecutor &seq_scan)
     {
-        auto &agg_values = group_map_[key];
-        if (agg_values.empty())
+        auto &pool = ThreadPool::instance();
+        struct Partial
         {
-            init_map(key, record);
-        }
-
-        for (size_t i = 0; i < sel_col_metas_.size(); ++i)
+            std::vector<AggHashTable> tables;
+            std::vector<std::vector<size_t>> first_rows; // 每个分组第一次出现的记录下标
+        };
+        std::vector<Partial> partials(pool.worker_num());
+        for (auto &partial : partials)
         {
-            const auto &sel_col = sel_cols_[i];
-            if (sel_col.aggFuncType == ast::COUNT)
-            {
-                agg_values[i].int_val += 1;
-                continue;
-            }
-            const auto &col_meta = sel_col_metas_[i];
-            Value value;
+            partial.tables.assign(AGG_PARTITIONS, AggHashTable(key_len_, TupleLen));
+            partial.first_rows.resize(AGG_PARTITIONS);
+        }
 
-            // 直接访问数据类型并赋值
-            if (col_meta->type == TYPE_INT)
-            {
-                value.set_int(*reinterpret_cast<int *>(record.data + col_meta->offset));
-            }
-            else if (col_meta->type == TYPE_FLOAT)
+        std::vector<std::vector<char>> keys(pool.worker_num(), std::vector<char>(key_len_));
+        seq_scan.parallel_scan([&](size_t idx, const char *row, size_t worker)
+                               {
+            auto &partial = partials[worker];
+            auto key = keys[worker].data();
+            generateGroupByKey(row, key);
+            uint64_t hash = partial.tables[0].hash_key(key);
+            size_t part = (hash >> 32) & (AGG_PARTITIONS - 1);
+            auto &table = partial.tables[part];
+            bool inserted;
+            auto group = table.find_or_insert(key, hash, inserted);
+            aggregateRow(table.accumulator(group), row, inserted);
+            // 窃取来的 morsel 可能比已经处理过的更靠前，需要取最小值
+            auto &first_rows = partial.first_rows[part];
+            if (inserted)
             {
-                value.set_float(*reinterpret_cast<float *>(record.data + col_meta->offset));
+                first_rows.push_back(idx);
             }
-            else if (col_meta->type == TYPE_STRING)
+            else
             {
-                value.set_str(std::string(record.data + col_meta->offset, col_meta->len));
+                first_rows[group] = std::min(first_rows[group], idx);
             }
-
-            switch (sel_col.aggFuncType)
+        });
+
+        std::vector<AggHashTable> merged(AGG_PARTITIONS, AggHashTable(key_len_, TupleLen));
+        std::vector<std::vector<size_t>> merged_first_rows(AGG_PARTITIONS);
+        pool.parallel_for(AGG_PARTITIONS, [&](size_t part, size_t)
+                          {
+            auto &table = merged[part];
+            auto &first_rows = merged_first_rows[part];
+            for (auto &partial : partials)
             {
-            case ast::SUM:
-                if (value.type == TYPE_INT)
-                {
-                    agg_values[i].int_val += value.int_val;
-                }
-                else if (value.type == TYPE_FLOAT)
-                {
-                    agg_values[i].float_val += value.float_val;
-                }
-                break;
-            case ast::MAX:
-                if (value.type == TYPE_INT && agg_values[i].int_val < value.int_val)
-                {
-                    agg_values[i].int_val = value.int_val;
-                }
-                else if (value.type == TYPE_FLOAT && agg_values[i].float_val < value.float_val)
-                {
-                    agg_values[i].float_val = value.float_val;
-                }
-                else if (value.type == TYPE_STRING && agg_values[i].str_val < value.str_val)
-                {
-                    agg_values[i].set_str(value.str_val);
-                }
-                break;
-            case ast::MIN:
-                if (value.type == TYPE_INT && agg_values[i].int_val > value.int_val)
-                {
-                    agg_values[i].int_val = value.int_val;
-                }
-                else if (value.type == TYPE_FLOAT && agg_values[i].float_val > value.float_val)
+                auto &local = partial.tables[part];
+                for (size_t i = 0; i < local.size(); i++)
                 {
-                    agg_values[i].float_val = value.float_val;
-                }
-                else if (value.type == TYPE_STRING && agg_values[i].str_val > value.str_val)
-                {
-                    agg_values[i].set_str(value.str_val);
+                    size_t first_row = partial.first_rows[part][i];
+                    bool inserted;
+                    auto group = table.find_or_insert(local.key(i), local.hash(i), inserted);
+                    if (inserted)
+                    {
+                        memcpy(table.accumulator(group), local.accumulator(i), TupleLen);
+                        first_rows.push_back(first_row);
+                        continue;
+                    }
+                    bool other_first = first_row < first_rows[group];
+                    for (const auto &col : agg_columns_)
+                    {
+                        col.impl.merge(table.accumulator(group) + col.slot_offset, local.accumulator(i) + col.slot_offset, col.len, other_first);
+                    }
+                    first_rows[group] = std::min(first_rows[group], first_row);
                 }
-                break;
-            case ast::default_type:
-                break;
-            default:
-                throw RMDBError();
+            } });
+
+        std::vector<std::pair<size_t, const char *>> ordered;
+        for (size_t part = 0; part < AGG_PARTITIONS; part++)
+        {
+            for (size_t i = 0; i < merged[part].size(); i++)
+            {
+                ordered.emplace_back(merged_first_rows[part][i], merged[part].accumulator(i));
             }
         }
+        std::sort(ordered.begin(), ordered.end());
+        std::vector<const char *> groups;
+        groups.reserve(ordered.size());
+        for (auto &group : ordered)
+        {
+            groups.push_back(group.second);
+        }
+        generateResults(groups);
     }
 
-    void init_map(const std::string &key, const RmRecord &record)
+    void aggregateRow(char *acc, const char *row, bool inserted)
     {
-        insert_order_.push_back(key);
-        auto &agg_values = group_map_[key];
-        agg_values.resize(sel_cols_.size());
-
-        // Initialize the default values for each aggregation function
-        for (size_t i = 0; i < sel_cols_.size(); ++i)
+        if (inserted)
         {
-            auto agg_type = sel_cols_[i].aggFuncType;
-
-            if (agg_type == ast::COUNT)
-            {
-                agg_values[i].set_int(0);
-            }
-            else if (agg_type == ast::SUM || agg_type == ast::MAX || agg_type == ast::MIN)
-            {
-                auto col = get_col(child_executor_->cols(), {sel_cols_[i].tab_name, sel_cols_[i].col_name});
-                switch (col->type)
-                {
-                case TYPE_INT:
-                    if (agg_type == ast::MIN)
-                        agg_values[i].set_int(std::numeric_limits<int>::max());
-                    else if (agg_type == ast::MAX)
-                        agg_values[i].set_int(std::numeric_limits<int>::min());
-                    else
-                        agg_values[i].set_int(0);
-                    break;
-
-                case TYPE_FLOAT:
-                    if (agg_type == ast::MIN)
-                        agg_values[i].set_float(std::numeric_limits<float>::max());
-                    else if (agg_type == ast::MAX)
-                        agg_values[i].set_float(std::numeric_limits<float>::lowest());
-                    else
-                        agg_values[i].set_float(0.0f);
-                    break;
-                case TYPE_STRING:
-                    if (agg_type == ast::MIN)
-                    {
-                        auto str_len = col->len;
-                        std::string max_str(str_len, '~');
-                        agg_values[i].set_str(max_str);
-                    }
-                    else if (agg_type == ast::MAX)
-                    {
-                        // Initialize with a low string value for MAX
-                        agg_values[i].set_str("");
-                    }
-                    else
-                    {
-                        throw RMDBError();
-                    }
-                    break;
-                default:
-                    throw RMDBError();
-                }
-            }
-            else
+            for (const auto &col : agg_columns_)
             {
-                // 被group by的列,非聚合函数
-                auto col = get_col(child_executor_->cols(), {sel_cols_[i].tab_name, sel_cols_[i].col_name});
-                if (col->type == TYPE_INT)
-                {
-                    agg_values[i].set_int(*reinterpret_cast<int *>(record.data + col->offset));
-                }
-                else if (col->type == TYPE_FLOAT)
-                {
-                    agg_values[i].set_float(*reinterpret_cast<float *>(record.data + col->offset));
-                }
-                else if (col->type == TYPE_STRING)
-                {
-                    agg_values[i].set_str(std::string(record.data + col->offset, col->len));
-                }
+                col.impl.init(acc + col.slot_offset, row + col.input_offset, col.len);
             }
+            return;
+        }
+        for (const auto &col : agg_columns_)
+        {
+            col.impl.update(acc + col.slot_offset, row + col.input_offset, col.len);
         }
     }
 
-    void generateResults()
+    // 把 group by 字段拼接成定长的分组键，没有 group by 时分组键为空，所有记录属于同一个分组
+    inline void generateGroupByKey(const char *row, char *key)
+    {
+        for (const auto &col_meta : group_by_col_metas_)
+        {
+            memcpy(key, row + col_meta->offset, col_meta->len);
+            key += col_meta->len;
+        }
+    }
+
+    // groups 为按输出顺序排列的各分组累加器
+    void generateResults(const std::vector<const char *> &groups)
     {
-        if (group_map_.empty())
+        if (groups.empty())
         {
             // 处理没有数据聚合但需要返回 COUNT() 结果的情况
             RmRecord record(TupleLen);
@@ -358,33 +339,11 @@ private:
         }
         else
         {
-            // 正常处理聚合数据
-            for (const auto &entry : insert_order_)
+            // 正常处理聚合数据，按分组第一次出现的顺序输出
+            for (auto group : groups)
             {
                 RmRecord record(TupleLen);
-                char *data_ptr = record.data;
-
-                // 将聚合值复制到结果记录中
-                for (const auto &val : group_map_[entry])
-                {
-                    switch (val.type)
-                    {
-                    case TYPE_INT:
-                        std::memcpy(data_ptr, &val.int_val, sizeof(val.int_val));
-                        data_ptr += sizeof(val.int_val);
-                        break;
-                    case TYPE_FLOAT:
-                        std::memcpy(data_ptr, &val.float_val, sizeof(val.float_val));
-                        data_ptr += sizeof(val.float_val);
-                        break;
-                    case TYPE_STRING:
-                        std::memcpy(data_ptr, val.str_val.c_str(), val.str_val.size());
-                        data_ptr += val.str_val.size();
-                        break;
-                    default:
-                        throw RMDBError();
-                    }
-                }
+                std::memcpy(record.data, group, TupleLen);
                 results_.push_back(std::move(record));
             }
         }
@@ -398,6 +357,10 @@ private:
     std::vector<TabCol> sel_cols_;
     std::vector<HavingCond> having_conds_;
 
+    // 构造时在儿子的输出中找到 HAVING 条件左侧的列和每个输出列，之后按位置取值
+    std::vector<std::vector<ColMeta>::const_iterator> having_col_metas_;
+    std::vector<std::vector<ColMeta>::const_iterator> source_col_metas_;
+
     int tuplelen;
     std::vector<ColMeta> output_cols_;
     std::vector<RmRecord> results_;
@@ -414,7 +377,8 @@ public:
         {
             if (col.aggFuncType == ast::COUNT)
             {
-                ColMeta col_meta(col.tab_name, col.col_name, TYPE_INT, col.aggFuncType, sizeof(int), offset, false);
+                ColMeta col_meta(col.tab_name, col.col_name, TYPE_INT, col.aggFuncType, sizeof(int), offset, false, col.col_idx);
+                col_meta.tab_id = col.tab_id;
                 offset += col_meta.len;
                 output_cols_.push_back(col_meta);
             }
@@ -429,8 +393,13 @@ public:
                 offset += col_meta.len;
                 output_cols_.push_back(col_meta);
             }
+            source_col_metas_.push_back(get_col_type(child_executor_->cols(), col, col.aggFuncType));
         }
         tuplelen = offset;
+        for (const auto &cond : having_conds_)
+        {
+            having_col_metas_.push_back(get_col_type(child_executor_->cols(), cond.lhs_col, cond.lhs_col.aggFuncType));
+        }
     }
 
     size_t tupleLen() const override { return tuplelen; }
@@ -490,9 +459,9 @@ private:
 
     bool checkHavingConditions(const std::unique_ptr<RmRecord> &record)
     {
-        for (HavingCond &cond : having_conds_)
+        for (size_t i = 0; i < having_conds_.size(); i++)
         {
-            if (!evaluateCondition(record, cond))
+            if (!evaluateCondition(record, having_conds_[i], *having_col_metas_[i]))
             {
                 return false;
             }
@@ -500,10 +469,10 @@ private:
         return true;
     }
 
-    bool evaluateCondition(const std::unique_ptr<RmRecord> &record, HavingCond &cond)
+    bool evaluateCondition(const std::unique_ptr<RmRecord> &record, HavingCond &cond, const ColMeta &lhs_col)
     {
         // Evaluate the left-hand side column value from the record
-        auto lhs_value = getColValue(record, cond.lhs_col);
+        auto lhs_value = getColValue(record, lhs_col);
 
         // Compare the lhs_value with rhs_val
         if (!can_cast_type(lhs_value.type, cond.rhs_val.type) && !can_cast_type(cond.rhs_val.type, lhs_value.type))
@@ -541,21 +510,20 @@ private:
         }
     }
 
-    Value getColValue(const std::unique_ptr<RmRecord> &record, const TabCol &col)
+    Value getColValue(const std::unique_ptr<RmRecord> &record, const ColMeta &col_meta)
     {
-        auto col_meta = get_col_type(child_executor_->cols(), col, col.aggFuncType);
         Value value;
-        if (col_meta->type == TYPE_INT)
+        if (col_meta.type == TYPE_INT)
         {
-            value.set_int(*reinterpret_cast<const int *>(record->data + col_meta->offset));
+            value.set_int(*reinterpret_cast<const int *>(record->data + col_meta.offset));
         }
-        else if (col_meta->type == TYPE_FLOAT)
+        else if (col_meta.type == TYPE_FLOAT)
         {
-            value.set_float(*reinterpret_cast<const float *>(record->data + col_meta->offset));
+            value.set_float(*reinterpret_cast<const float *>(record->data + col_meta.offset));
         }
-        else if (col_meta->type == TYPE_STRING)
+        else if (col_meta.type == TYPE_STRING)
         {
-            value.set_str(std::string(record->data + col_meta->offset, col_meta->len));
+            value.set_str(std::string(record->data + col_meta.offset, col_meta.len));
         }
         else
         {
@@ -599,10 +567,7 @@ private:
     {
         auto pos = std::find_if(rec_cols.begin(), rec_cols.end(), [&](const ColMeta &col)
                                 {
-            if (col.tab_name == target.tab_name && col.name == target.col_name && col.agg_func_type == target.aggFuncType) {
-                return true;
-            }
-            return false; });
+            return target.refers_to(col) && col.agg_func_type == target.aggFuncType; });
 
         if (pos == rec_cols.end())
         {
@@ -614,23 +579,14 @@ private:
 
     void generateResults()
     {
-        auto child_col = child_executor_->cols();
-        std::vector<ColMeta> sel_col = output_cols_;
-
         std::vector<RmRecord> final_results;
         for (const auto &result_it : results_)
         {
             RmRecord new_record(tupleLen());
             char *data_ptr = new_record.data;
 
-            for (const auto &col : sel_col)
+            for (const auto &col_meta_it : source_col_metas_)
             {
-                TabCol temp;
-                temp.tab_name = col.tab_name;
-                temp.col_name = col.name;
-                temp.aggFuncType = col.agg_func_type;
-                auto col_meta_it = get_col_type(child_col, temp, col.agg_func_type);
-
                 const ColMeta &col_meta = *col_meta_it;
                 std::memcpy(data_ptr, result_it.data + col_meta.offset, col_meta.len);
                 data_ptr += col_meta.len;
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common/common_finals.h"
+
+// 连接条件中的一个字段：在左记录还是右记录中，以及在该记录中的偏移
+struct JoinOperand
+{
+    bool is_right;
+    int offset;
+};
+
+// 按类型和比较运算特化的比较函数，参数为左右两侧的值及其长度
+using JoinMatchFn = bool (*)(const char *lhs, int len, const char *rhs, int rhs_len);
+
+// 按左右儿子输出记录解析后的连接条件，比较时不再按列名查找
+struct JoinCond
+{
+    JoinOperand lhs;
+    JoinOperand rhs;
+    int len;     // 左侧字段长度
+    int rhs_len; // 右侧字段长度，只有字符串可能与左侧不同
+    ColType type;
+    CompOp op;
+    int rhs_col_idx;   // 右侧字段在表中的序号，用于匹配索引
+    JoinMatchFn match; // 构造时按 type 和 op 选定，逐行比较时不再分支
+};
+
+// 字符串以 0 填充到字段长度，长度不同的字段比较时较长一侧多出的部分必须全为 0 才算相等
+inline int compare_join_value(const char *a, int a_len, const char *b, int b_len, ColType type)
+{
+    switch (type)
+    {
+    case TYPE_INT:
+    {
+        int ia = *reinterpret_cast<const int *>(a);
+        int ib = *reinterpret_cast<const int *>(b);
+        return (ia > ib) - (ia < ib);
+    }
+    case TYPE_FLOAT:
+    {
+        float fa = *reinterpret_cast<const float *>(a);
+        float fb = *reinterpret_cast<const float *>(b);
+        return (fa > fb) - (fa < fb);
+    }
+    case TYPE_STRING:
+    {
+        int res = memcmp(a, b, std::min(a_len, b_len));
+        if (res != 0 || a_len == b_len)
+        {
+            return res;
+        }
+        if (a_len > b_len)
+        {
+            return a[b_len] != 0;
+        }
+        return -(b[a_len] != 0);
+    }
+    }
+    return 0;
+}
+
+template <CompOp op, typename T>
+inline bool apply_comp_op(const T &a, const T &b)
+{
+    if constexpr (op == OP_EQ)
+        return a == b;
+    else if constexpr (op == OP_LT)
+        return a < b;
+    else if constexpr (op == OP_GT)
+        return a > b;
+    else if constexpr (op == OP_LE)
+        return a <= b;
+    else
+        return a >= b;
+}
+
+template <ColType type, CompOp op>
+bool match_join_value(const char *lhs, int len, const char *rhs, int rhs_len)
+{
+    if constexpr (type == TYPE_INT)
+    {
+        int a, b;
+        memcpy(&a, lhs, sizeof(a));
+        memcpy(&b, rhs, sizeof(b));
+        return apply_comp_op<op>(a, b);
+    }
+    else if constexpr (type == TYPE_FLOAT)
+    {
+        float a, b;
+        memcpy(&a, lhs, sizeof(a));
+        memcpy(&b, rhs, sizeof(b));
+        return apply_comp_op<op>(a, b);
+    }
+    else
+    {
+        int res = len == rhs_len ? memcmp(lhs, rhs, len) : compare_join_value(lhs, len, rhs, rhs_len, TYPE_STRING);
+        return apply_comp_op<op>(res, 0);
+    }
+}
+
+template <ColType type>
+JoinMatchFn typed_join_match_fn(CompOp op)
+{
+    switch (op)
+    {
+    case OP_EQ:
+        return &match_join_value<type, OP_EQ>;
+    case OP_LT:
+        return &match_join_value<type, OP_LT>;
+    case OP_GT:
+        return &match_join_value<type, OP_GT>;
+    case OP_LE:
+        return &match_join_value<type, OP_LE>;
+    case OP_GE:
+        return &match_join_value<type, OP_GE>;
+    }
+    throw RMDBError();
+}
+
+inline JoinMatchFn join_match_fn(ColType type, CompOp op)
+{
+    switch (type)
+    {
+    case TYPE_INT:
+        return typed_join_match_fn<TYPE_INT>(op);
+    case TYPE_FLOAT:
+        return typed_join_match_fn<TYPE_FLOAT>(op);
+    case TYPE_STRING:
+        return typed_join_match_fn<TYPE_STRING>(op);
+    }
+    throw RMDBError();
+}
+
+// 在左右儿子的字段中查找连接条件引用的列，字段偏移取自儿子节点而非表元数据
+inline JoinCond make_join_cond(const std::vector<ColMeta> &left_cols, const std::vector<ColMeta> &right_cols, const TabCol &lhs_col, const TabCol &rhs_col, CompOp op)
+{
+    auto resolve = [&](const TabCol &target, JoinOperand &operand) -> const ColMeta &
+    {
+        auto match = [&](const ColMeta &col)
+        { return target.refers_to(col); };
+        auto pos = std::find_if(left_cols.begin(), left_cols.end(), match);
+        operand.is_right = pos == left_cols.end();
+        if (operand.is_right)
+        {
+            pos = std::find_if(right_cols.begin(), right_cols.end(), match);
+            if (pos == right_cols.end())
+            {
+                throw RMDBError();
+            }
+        }
+        operand.offset = pos->offset;
+        return *pos;
+    };
+    JoinCond cond{};
+    auto &lhs_meta = resolve(lhs_col, cond.lhs);
+    auto &rhs_meta = resolve(rhs_col, cond.rhs);
+    cond.len = lhs_meta.len;
+    cond.rhs_len = rhs_meta.len;
+    cond.type = lhs_meta.type;
+    cond.op = op;
+    cond.rhs_col_idx = rhs_meta.idx;
+    cond.match = join_match_fn(cond.type, op);
+    return cond;
+}
+
+inline bool eval_join_cond(const JoinCond &cond, const char *left, const char *right)
+{
+    const char *lhs = (cond.lhs.is_right ? right : left) + cond.lhs.offset;
+    const char *rhs = (cond.rhs.is_right ? right : left) + cond.rhs.offset;
+    return cond.match(lhs, cond.len, rhs, cond.rhs_len);
+}
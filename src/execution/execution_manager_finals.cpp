@@ -170,6 +170,17 @@ void QlManager::run_cmd_utility(const std::shared_ptr<Plan> &plan, txn_id_t *txn
             planner_->set_enable_sortmerge_join(x->bool_value_);
             break;
         }
+        case ast::SetKnobType::EnableHashJoin:
+        {
+            planner_->set_enable_hashjoin(x->bool_value_);
+            break;
+        }
+        case ast::SetKnobType::EnableResultStream:
+        {
+            // 只影响当前连接
+            context->stream_ = x->bool_value_;
+            break;
+        }
         default:
         {
             throw RMDBError();
@@ -225,74 +236,37 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot,
     rec_printer.print_record(captions, context);
     rec_printer.print_separator(context);
     // print header into file
-    std::fstream outfile;
-    if (sm_manager_->io_enabled_)
-    {
-        outfile.open("output.txt", std::ios::out | std::ios::app);
-        outfile << "|";
-        for (const auto &caption : captions)
-        {
-            outfile << " " << caption << " |";
-        }
-        outfile << "\n";
-    }
+    OutputBuffer out(sm_manager_->io_enabled_);
+    std::vector<std::string_view> cells(captions.begin(), captions.end());
+    RecordPrinter::write_record(cells.data(), cells.size(), out);
 
     // Print records
+    // 字段值直接格式化到 bufs 中，同一份文本写入发送缓冲区和 output.txt
+    const auto &cols = executorTreeRoot->cols();
+    std::vector<std::array<char, VALUE_FORMAT_BUF_SIZE>> bufs(cols.size());
+    cells.resize(cols.size());
     size_t num_rec = 0;
     // 执行query_plan
     for (executorTreeRoot->beginTuple(); !executorTreeRoot->is_end(); executorTreeRoot->nextTuple())
     {
-        if (!sm_manager_->io_enabled_ && context->data_send_is_full())
+        if (!out.enabled() && context->data_send_is_full())
         {
             break;
         }
         auto Tuple = executorTreeRoot->Next();
-        std::vector<std::string> columns;
-        for (auto &col : executorTreeRoot->cols())
+        for (size_t i = 0; i < cols.size(); i++)
         {
-            std::string col_str;
-            char *rec_buf = Tuple->data + col.offset;
-            if (col.type == TYPE_INT)
-            {
-                auto val = *(int *)rec_buf;
-                if (val == INT_MAX)
-                    col_str = "";
-                else
-                    col_str = std::to_string(*(int *)rec_buf);
-            }
-            else if (col.type == TYPE_FLOAT)
-            {
-                auto val = *(float *)rec_buf;
-                if (val == FLT_MAX)
-                    col_str = "";
-                else
-                    col_str = std::to_string(*(float *)rec_buf);
-            }
-            else if (col.type == TYPE_STRING)
-            {
-                col_str = std::string((char *)rec_buf, col.len);
-                col_str.resize(strlen(col_str.c_str()));
-            }
-            columns.push_back(col_str);
+            cells[i] = RecordPrinter::format_value(cols[i].type, cols[i].len, Tuple->data + cols[i].offset, bufs[i].data());
         }
         // print record into buffer
-        rec_printer.print_record(columns, context);
+        RecordPrinter::print_record(cells.data(), cells.size(), context);
         // print record into file
-        if (sm_manager_->io_enabled_)
+        if (out.enabled())
         {
-            outfile << "|";
-            for (const auto &column : columns)
-            {
-                outfile << " " << column << " |";
-            }
-            outfile << "\n";
+            RecordPrinter::write_record(cells.data(), cells.size(), out);
         }
         num_rec++;
     }
-    if (sm_manager_->io_enabled_)
-    {
-        outfile.close();
-    }
     // Print footer into buffer
     rec_printer.print_separator(context);
     // Print record count into buffer
@@ -3,6 +3,8 @@
 #include <fstream>
 #include <utility>
 
+#include "execution_join_cond_finals.h"
+
 //
 // Created by root on 24-6-12.
 //
@@ -20,7 +22,8 @@ private:
 
     std::vector<std::string> tables;
 
-    std::vector<Condition> join_conds_; // 连接条件
+    std::vector<JoinCond> join_conds_; // 连接条件，构造时解析字段偏移并选定比较函数
+    bool conds_type_mismatch_ = false; // 有两侧类型不同的条件时没有满足条件的记录
 
     // 等值连接左列属性
     std::vector<ColMeta>::const_iterator left_join_col;
@@ -33,7 +36,7 @@ private:
     bool right_end_;
 
 public:
-    MergeJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, std::vector<Condition> conds, const TabCol &left_col, const TabCol &right_col, std::vector<std::string> tables_) : left_executor_(std::move(left)), right_executor_(std::move(right)), tables(std::move(tables_)), join_conds_(std::move(conds))
+    MergeJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, std::vector<Condition> conds, const TabCol &left_col, const TabCol &right_col, std::vector<std::string> tables_) : left_executor_(std::move(left)), right_executor_(std::move(right)), tables(std::move(tables_))
     {
         tuple_length_ = left_executor_->tupleLen() + right_executor_->tupleLen();
         columns_ = left_executor_->cols();
@@ -46,6 +49,12 @@ public:
 
         left_join_col = get_col(left_executor_->cols(), left_col);
         right_join_col = get_col(right_executor_->cols(), right_col);
+
+        for (const auto &cond : conds)
+        {
+            conds_type_mismatch_ |= get_col(columns_, cond.lhs_col)->type != get_col(columns_, cond.rhs_col)->type;
+            join_conds_.push_back(make_join_cond(left_executor_->cols(), right_executor_->cols(), cond.lhs_col, cond.rhs_col, cond.op));
+        }
     }
 
     void beginTuple() override
@@ -121,70 +130,19 @@ private:
         }
     }
 
-    bool evaluateCondition(const RmRecord *left_record, const RmRecord *right_record, const Condition &cond)
-    {
-        auto lhs_column_meta = get_col(columns_, cond.lhs_col);
-        auto rhs_column_meta = get_col(columns_, cond.rhs_col);
-        auto lhs_data = left_record->data + lhs_column_meta->offset;
-        auto rhs_data = right_record->data + rhs_column_meta->offset - left_executor_->tupleLen();
-        ColType rhs_type = rhs_column_meta->type;
-        if (lhs_column_meta->type != rhs_type)
-        {
-            return false;
-        }
-        int comparison_result = compareValues(lhs_data, rhs_data, lhs_column_meta->len, rhs_type);
-        switch (cond.op)
-        {
-        case OP_EQ:
-            return comparison_result == 0;
-        case OP_LT:
-            return comparison_result < 0;
-        case OP_GT:
-            return comparison_result > 0;
-        case OP_LE:
-            return comparison_result <= 0;
-        case OP_GE:
-            return comparison_result >= 0;
-        default:
-            throw RMDBError();
-        }
-    }
-
     bool evaluateConditions(const RmRecord *left_record, const RmRecord *right_record)
     {
-        return std::all_of(join_conds_.begin(), join_conds_.end(), [&](const Condition &cond)
-                           { return evaluateCondition(left_record, right_record, cond); });
+        return !conds_type_mismatch_ && std::all_of(join_conds_.begin(), join_conds_.end(), [&](const JoinCond &cond)
+                                                    { return eval_join_cond(cond, left_record->data, right_record->data); });
     }
 
-    static int compareValues(const char *a, const char *b, int column_length, ColType column_type)
-    {
-        switch (column_type)
-        {
-        case TYPE_INT:
-        {
-            int ai = *(int *)a;
-            int bi = *(int *)b;
-            return ai > bi ? 1 : (ai < bi ? -1 : 0);
-        }
-        case TYPE_FLOAT:
-        {
-            double af = *(double *)a;
-            double bf = *(double *)b;
-            return af > bf ? 1 : (af < bf ? -1 : 0);
-        }
-        case TYPE_STRING:
-            return memcmp(a, b, column_length);
-        default:
-            throw RMDBError();
-        }
-    }
     int compare_record(std::unique_ptr<RmRecord> &left_record, std::unique_ptr<RmRecord> &right_record)
     {
         if (left_join_col->type != right_join_col->type)
         {
             throw RMDBError();
         }
-        return compareValues(left_record->data + left_join_col->offset, right_record->data + right_join_col->offset, left_join_col->len, left_join_col->type);
+        return compare_join_value(left_record->data + left_join_col->offset, left_join_col->len, right_record->data + right_join_col->offset, right_join_col->len, left_join_col->type);
     }
 };
 
@@ -1,14 +1,11 @@
 #pragma once
 
 #include <algorithm>
-#include <cassert>
 #include <cstring>
-#include <fstream>
-#include <functional>
 #include <memory>
-#include <queue>
 #include <vector>
 
+#include "execution_external_sort_finals.h"
 #include "execution_manager_finals.h"
 #include "executor_abstract_finals.h"
 
@@ -16,35 +13,40 @@ class SortExecutor : public AbstractExecutor
 {
 private:
     std::unique_ptr<AbstractExecutor> prev_;
-    ColMeta col_;  // 单字段排序
-    bool is_desc_; // 题目要求升序
-    size_t tuple_num;
-    std::vector<std::unique_ptr<RmRecord>> tuples_;
-    size_t current_index;
+    std::unique_ptr<ExternalSorter> sorter_; // 按 order by 的各个字段排序，可以混合升序和降序
+    bool sorted_ = false;
     size_t len_;
 
 public:
-    SortExecutor(std::unique_ptr<AbstractExecutor> prev, const TabCol &sel_col) : prev_(std::move(prev)), current_index(0)
+    SortExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols, const std::vector<bool> &is_descs, Context *context)
+        : prev_(std::move(prev))
     {
-        col_ = *get_col(prev_->cols(), sel_col);
+        std::vector<SortKeyCol> key_cols;
+        for (size_t i = 0; i < sel_cols.size(); i++)
+        {
+            auto col = get_col(prev_->cols(), sel_cols[i]);
+            key_cols.push_back({col->offset, col->len, col->type, is_descs[i]});
+        }
         len_ = prev_->tupleLen();
-        tuple_num = 0;
-        is_desc_ = false;
+        sorter_ = std::make_unique<ExternalSorter>(SortKeyEncoder(std::move(key_cols)), len_, context);
     }
 
     void beginTuple() override
     {
-        current_index = 0;
-        if (!tuples_.empty())
+        if (sorted_)
+        {
+            sorter_->rewind();
             return;
+        }
         get_sort_next_tuples();
+        sorted_ = true;
     }
 
     void nextTuple() override
     {
-        if (current_index < tuples_.size())
+        if (!sorter_->is_end())
         {
-            ++current_index;
+            sorter_->next();
         }
     }
 
@@ -54,10 +56,15 @@ public:
         {
             return nullptr;
         }
-        return std::make_unique<RmRecord>(*tuples_[current_index]);
+        if (!sorter_->spilled())
+        {
+            return std::make_unique<RmRecord>(sorter_->row(), len_);
+        }
+        // 归并时读缓冲区会被下一条记录覆盖，上层（例如 merge join）可能跨 nextTuple 持有记录，需要拷贝
+        return std::make_unique<RmRecord>(RmRecord::copy_of(sorter_->row(), len_));
     }
 
-    bool is_end() const override { return tuples_.empty() || current_index >= tuples_.size(); }
+    bool is_end() const override { return sorter_->is_end(); }
 
     size_t tupleLen() const override { return len_; }
 
@@ -66,58 +73,13 @@ public:
     ~SortExecutor() override = default;
 
 private:
+    // 每行只编码一次规范化键，排序时比较键而不再构造 Value；超出内存预算时溢出到临时文件
     void get_sort_next_tuples()
     {
         for (prev_->beginTuple(); !prev_->is_end(); prev_->nextTuple())
         {
-            tuple_num++;
-            tuples_.emplace_back(prev_->Next());
-        }
-        if (tuples_.empty())
-            return;
-
-        std::sort(tuples_.begin(), tuples_.end(), [this](const std::unique_ptr<RmRecord> &a, const std::unique_ptr<RmRecord> &b)
-                  { return compareRecords(a, b); });
-    }
-
-    bool compareRecords(const std::unique_ptr<RmRecord> &a, const std::unique_ptr<RmRecord> &b) const
-    {
-        Value lhs = getValue(a, col_.offset, col_.type);
-        Value rhs = getValue(b, col_.offset, col_.type);
-        if (lhs != rhs)
-        {
-            return is_desc_ ? lhs > rhs : lhs < rhs;
-        }
-        return false;
-    }
-
-    static Value getValue(const std::unique_ptr<RmRecord> &record, size_t offset, ColType col_type)
-    {
-        const char *buf = record->data + offset;
-        Value value;
-        switch (col_type)
-        {
-        case TYPE_INT:
-        {
-            int int_value = *reinterpret_cast<const int *>(buf);
-            value.set_int(int_value);
-            break;
-        }
-        case TYPE_FLOAT:
-        {
-            float float_value = *reinterpret_cast<const float *>(buf);
-            value.set_float(float_value);
-            break;
-        }
-        case TYPE_STRING:
-        {
-            std::string str_value(buf, strnlen(buf, 256)); // 假设最大字符串长度为256
-            value.set_str(str_value);
-            break;
-        }
-        default:
-            throw RMDBError();
+            sorter_->add(prev_->Next()->data);
         }
-        return value;
+        sorter_->finish();
     }
 };
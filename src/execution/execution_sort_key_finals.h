@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "common/common_finals.h"
+#include "common/config_finals.h"
+#include "common/thread_pool_finals.h"
+
+// 排序键中的一个字段
+struct SortKeyCol
+{
+    int offset;
+    int len;
+    ColType type;
+    bool is_desc;
+};
+
+// 把多个排序字段编码成定长的规范化键，键之间直接按字节（memcmp）比较即可得到 order by 的顺序：
+// 整数翻转符号位、浮点数按 IEEE 754 位模式变换后按大端存放，字符串拷贝到结尾的 0 为止并以 0 填充；降序字段的字节全部取反
+class SortKeyEncoder
+{
+public:
+    SortKeyEncoder() = default;
+
+    explicit SortKeyEncoder(std::vector<SortKeyCol> cols) : cols_(std::move(cols))
+    {
+        for (const auto &col : cols_)
+        {
+            key_len_ += col.len;
+        }
+    }
+
+    size_t key_len() const { return key_len_; }
+
+    void encode(const char *row, char *key) const
+    {
+        for (const auto &col : cols_)
+        {
+            const char *value = row + col.offset;
+            switch (col.type)
+            {
+            case TYPE_INT:
+            {
+                uint32_t bits;
+                memcpy(&bits, value, sizeof(bits));
+                store_big_endian(key, bits ^ 0x80000000u);
+                break;
+            }
+            case TYPE_FLOAT:
+            {
+                float f;
+                memcpy(&f, value, sizeof(f));
+                if (f == 0)
+                {
+                    f = 0; // -0.0 与 0.0 相等
+                }
+                uint32_t bits;
+                memcpy(&bits, &f, sizeof(bits));
+                store_big_endian(key, (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u);
+                break;
+            }
+            default:
+            {
+                // 字符串在第一个 0 处结束，之后的字节不一定是 0
+                size_t len = strnlen(value, col.len);
+                memcpy(key, value, len);
+                memset(key + len, 0, col.len - len);
+                break;
+            }
+            }
+            if (col.is_desc)
+            {
+                for (int i = 0; i < col.len; i++)
+                {
+                    key[i] = static_cast<char>(~key[i]);
+                }
+            }
+            key += col.len;
+        }
+    }
+
+private:
+    static void store_big_endian(char *key, uint32_t bits)
+    {
+        for (int i = 3; i >= 0; i--)
+        {
+            key[i] = static_cast<char>(bits & 0xff);
+            bits >>= 8;
+        }
+    }
+
+    std::vector<SortKeyCol> cols_;
+    size_t key_len_ = 0;
+};
+
+// 对 row_num 个规范化键排序，返回按键升序排列的行号，键相同的行保持原来的顺序
+// 每行用（键的前 8 个字节，行号）参与排序，前缀相同时才比较键的其余部分。
+// 行数较多时先按前缀做基数排序；行数很多时分块并行排序，再两两并行归并
+class NormalizedKeySorter
+{
+public:
+    NormalizedKeySorter(const char *keys, size_t key_len) : keys_(keys), key_len_(key_len) {}
+
+    std::vector<uint32_t> sort(size_t row_num) const
+    {
+        std::vector<Entry> entries(row_num);
+        for (size_t i = 0; i < row_num; i++)
+        {
+            entries[i] = {prefix(i), static_cast<uint32_t>(i)};
+        }
+        auto &pool = ThreadPool::instance();
+        size_t chunk_num = row_num >= PARALLEL_SORT_MIN_ROWS ? pool.worker_num() : 1;
+        auto bound = [&](size_t chunk)
+        { return row_num * chunk / chunk_num; };
+        pool.parallel_for(chunk_num, [&](size_t chunk, size_t)
+                          { sort_chunk(entries.data() + bound(chunk), entries.data() + bound(chunk + 1)); });
+
+        std::vector<Entry> buffer(chunk_num > 1 ? row_num : 0);
+        for (size_t width = 1; width < chunk_num; width *= 2)
+        {
+            for (size_t left = 0; left + width < chunk_num; left += 2 * width)
+            {
+                size_t begin = bound(left);
+                size_t mid = bound(left + width);
+                size_t end = bound(std::min(left + 2 * width, chunk_num));
+                merge(entries.data() + begin, mid - begin, entries.data() + mid, end - mid, buffer.data() + begin);
+                std::copy(buffer.begin() + begin, buffer.begin() + end, entries.begin() + begin);
+            }
+        }
+
+        std::vector<uint32_t> order(row_num);
+        for (size_t i = 0; i < row_num; i++)
+        {
+            order[i] = entries[i].row;
+        }
+        return order;
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t prefix;
+        uint32_t row;
+    };
+
+    static constexpr size_t PREFIX_LEN = sizeof(uint64_t);
+
+    uint64_t prefix(size_t row) const
+    {
+        const auto *key = reinterpret_cast<const unsigned char *>(keys_ + row * key_len_);
+        uint64_t value = 0;
+        for (size_t i = 0; i < PREFIX_LEN; i++)
+        {
+            value = (value << 8) | (i < key_len_ ? key[i] : 0);
+        }
+        return value;
+    }
+
+    // 行号参与比较，所有项互不相等
+    bool less(const Entry &a, const Entry &b) const
+    {
+        if (a.prefix != b.prefix)
+        {
+            return a.prefix < b.prefix;
+        }
+        if (key_len_ > PREFIX_LEN)
+        {
+            int res = memcmp(keys_ + a.row * key_len_ + PREFIX_LEN, keys_ + b.row * key_len_ + PREFIX_LEN, key_len_ - PREFIX_LEN);
+            if (res != 0)
+            {
+                return res < 0;
+            }
+        }
+        return a.row < b.row;
+    }
+
+    // 块内的项按行号递增排列。基数排序是稳定的，排完后只需对前缀相同的段按完整的键再排序
+    void sort_chunk(Entry *first, Entry *last) const
+    {
+        auto cmp = [this](const Entry &a, const Entry &b)
+        { return less(a, b); };
+        size_t n = last - first;
+        if (n < SORT_RADIX_MIN_ROWS)
+        {
+            std::sort(first, last, cmp);
+            return;
+        }
+        radix_sort(first, n);
+        if (key_len_ <= PREFIX_LEN)
+        {
+            return;
+        }
+        for (Entry *run = first; run != last;)
+        {
+            Entry *run_end = run + 1;
+            while (run_end != last && run_end->prefix == run->prefix)
+            {
+                run_end++;
+            }
+            if (run_end - run > 1)
+            {
+                std::sort(run, run_end, cmp);
+            }
+            run = run_end;
+        }
+    }
+
+    // 按前缀从低字节到高字节做 LSD 基数排序，所有项该字节都相同的轮次跳过
+    static void radix_sort(Entry *entries, size_t n)
+    {
+        std::vector<Entry> buffer(n);
+        Entry *from = entries;
+        Entry *to = buffer.data();
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            size_t count[257] = {};
+            for (size_t i = 0; i < n; i++)
+            {
+                count[((from[i].prefix >> shift) & 0xff) + 1]++;
+            }
+            if (count[((from[0].prefix >> shift) & 0xff) + 1] == n)
+            {
+                continue;
+            }
+            for (int b = 0; b < 256; b++)
+            {
+                count[b + 1] += count[b];
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                to[count[(from[i].prefix >> shift) & 0xff]++] = from[i];
+            }
+            std::swap(from, to);
+        }
+        if (from != entries)
+        {
+            std::copy(from, from + n, entries);
+        }
+    }
+
+    // 把有序的 a、b 归并到 out：a 按下标均分给各线程，b 中对应的分界用二分查找确定
+    void merge(const Entry *a, size_t a_num, const Entry *b, size_t b_num, Entry *out) const
+    {
+        auto cmp = [this](const Entry &x, const Entry &y)
+        { return less(x, y); };
+        auto &pool = ThreadPool::instance();
+        size_t task_num = std::max<size_t>(1, std::min(pool.worker_num(), (a_num + b_num) / PARALLEL_SORT_MIN_ROWS));
+        auto split = [&](size_t task, size_t &a_split, size_t &b_split)
+        {
+            a_split = a_num * task / task_num;
+            if (task == 0 || task == task_num)
+            {
+                b_split = task == 0 ? 0 : b_num;
+            }
+            else
+            {
+                b_split = a_split == a_num ? b_num : std::lower_bound(b, b + b_num, a[a_split], cmp) - b;
+            }
+        };
+        pool.parallel_for(task_num, [&](size_t task, size_t)
+                          {
+            size_t a_begin, b_begin, a_end, b_end;
+            split(task, a_begin, b_begin);
+            split(task + 1, a_end, b_end);
+            std::merge(a + a_begin, a + a_end, b + b_begin, b + b_end, out + a_begin + b_begin, cmp); });
+    }
+
+    const char *keys_;
+    size_t key_len_;
+};
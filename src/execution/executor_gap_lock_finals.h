@@ -34,9 +34,8 @@ public:
         lower_key_ = memory_pool_manager_->allocate(fh_->record_size);
         upper_key_ = memory_pool_manager_->allocate(fh_->record_size);
 
-        for (const auto &meta : tab_->cols)
+        for (const auto &col_meta_ : tab_->cols)
         {
-            auto &col_meta_ = tab_->get_col(meta.name);
             switch (col_meta_.type)
             {
             case ColType::TYPE_INT:
@@ -70,7 +69,7 @@ public:
 
         for (auto &cond : conds_)
         {
-            auto &col_meta_ = tab_->get_col(cond.lhs_col.col_name);
+            auto &col_meta_ = cond.lhs_col.meta(*tab_);
             int offset = col_meta_.idx;
             col_idx_set_.insert(offset);
 
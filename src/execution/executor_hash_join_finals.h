@@ -0,0 +1,338 @@
+#pragma once
+
+#include <cstdint>
+
+#include "execution_join_cond_finals.h"
+#include "execution_manager_finals.h"
+#include "executor_abstract_finals.h"
+#include "storage/spill_file_finals.h"
+
+// 等值连接的 hash join
+// 右儿子作为 build 端，左儿子作为 probe 端；build 端在内存预算内时输出顺序与 nested loop join 相同，
+// 超出预算时退化为 grace hash join：两侧按 hash 分区写入溢出文件，再逐个分区（必要时递归分区）连接
+class HashJoinExecutor : public AbstractExecutor
+{
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // 等值连接键，左右字段类型相同
+    struct JoinKey
+    {
+        int left_offset;
+        int right_offset;
+        int left_len;
+        int right_len;
+        ColType type;
+    };
+
+    // 一个待处理的分区：build 端与 probe 端的溢出文件
+    struct Partition
+    {
+        std::unique_ptr<SpillFile> build;
+        std::unique_ptr<SpillFile> probe;
+        int depth;
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;  // probe 端
+    std::unique_ptr<AbstractExecutor> right_; // build 端
+    size_t left_len_;
+    size_t right_len_;
+    std::vector<ColMeta> cols_;
+    std::vector<JoinKey> keys_;
+    std::vector<JoinCond> residual_conds_; // 不能作为连接键的剩余条件
+    Context *context_;
+
+    // 内存中的 hash 表：build 端记录连续存放，桶内按记录原始顺序串成链
+    std::vector<char> build_rows_;
+    std::vector<uint32_t> buckets_;
+    std::vector<uint32_t> chain_;
+    uint64_t bucket_mask_ = 0;
+
+    bool spilled_ = false;
+    std::vector<Partition> partitions_;
+    std::unique_ptr<SpillFile> probe_file_; // 为空时直接从左儿子读取 probe 记录
+
+    std::vector<char> probe_row_;
+    uint32_t match_ = NONE;
+    bool is_end_ = true;
+
+public:
+    HashJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, const std::vector<Condition> &conds, Context *context) : left_(std::move(left)), right_(std::move(right)), context_(context)
+    {
+        left_len_ = left_->tupleLen();
+        right_len_ = right_->tupleLen();
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols)
+        {
+            col.offset += left_len_;
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        probe_row_.resize(left_len_);
+
+        for (const auto &cond : conds)
+        {
+            auto join_cond = make_join_cond(left_->cols(), right_->cols(), cond.lhs_col, cond.rhs_col, cond.op);
+            if (cond.op == OP_EQ && join_cond.lhs.is_right != join_cond.rhs.is_right)
+            {
+                if (join_cond.lhs.is_right)
+                {
+                    std::swap(join_cond.lhs, join_cond.rhs);
+                    std::swap(join_cond.len, join_cond.rhs_len);
+                }
+                keys_.push_back({join_cond.lhs.offset, join_cond.rhs.offset, join_cond.len, join_cond.rhs_len, join_cond.type});
+            }
+            else
+            {
+                residual_conds_.push_back(std::move(join_cond));
+            }
+        }
+    }
+
+    void beginTuple() override
+    {
+        spilled_ = false;
+        partitions_.clear();
+        probe_file_.reset();
+        match_ = NONE;
+        is_end_ = false;
+
+        build_rows_.clear();
+        std::vector<std::unique_ptr<SpillFile>> build_files;
+        for (right_->beginTuple(); !right_->is_end(); right_->nextTuple())
+        {
+            auto record = right_->Next();
+            if (spilled_)
+            {
+                write_partition(build_files, record->data, right_len_, 1, false);
+                continue;
+            }
+            build_rows_.insert(build_rows_.end(), record->data, record->data + right_len_);
+            if (build_rows_.size() > context_->memory_budget_)
+            {
+                // build 端超出内存预算，把已读入的记录连同剩余记录一起分区溢出
+                spilled_ = true;
+                build_files.resize(HASH_JOIN_PARTITIONS);
+                for (size_t pos = 0; pos < build_rows_.size(); pos += right_len_)
+                {
+                    write_partition(build_files, build_rows_.data() + pos, right_len_, 1, false);
+                }
+                std::vector<char>().swap(build_rows_);
+            }
+        }
+
+        left_->beginTuple();
+        if (!spilled_)
+        {
+            if (build_rows_.empty())
+            {
+                is_end_ = true;
+                return;
+            }
+            build_hash_table();
+            find_next_valid_tuple();
+            return;
+        }
+
+        std::vector<std::unique_ptr<SpillFile>> probe_files(HASH_JOIN_PARTITIONS);
+        for (; !left_->is_end(); left_->nextTuple())
+        {
+            auto record = left_->Next();
+            write_partition(probe_files, record->data, left_len_, 1, true);
+        }
+        push_partitions(build_files, probe_files, 1);
+        if (!next_partition())
+        {
+            is_end_ = true;
+            return;
+        }
+        find_next_valid_tuple();
+    }
+
+    void nextTuple() override
+    {
+        match_ = chain_[match_];
+        find_next_valid_tuple();
+    }
+
+    std::unique_ptr<RmRecord> Next() override
+    {
+        auto record = std::make_unique<RmRecord>(tupleLen());
+        memcpy(record->data, probe_row_.data(), left_len_);
+        memcpy(record->data + left_len_, build_row(match_), right_len_);
+        return record;
+    }
+
+    size_t tupleLen() const override { return left_len_ + right_len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    bool is_end() const override { return is_end_; }
+
+private:
+    const char *build_row(uint32_t idx) const { return build_rows_.data() + idx * right_len_; }
+
+    uint64_t hash_row(const char *row, bool is_probe, uint64_t seed) const
+    {
+        uint64_t h = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+        for (const auto &key : keys_)
+        {
+            const char *data = row + (is_probe ? key.left_offset : key.right_offset);
+            int len = is_probe ? key.left_len : key.right_len;
+            if (key.type == TYPE_STRING)
+            {
+                // 只对填充的 0 之前的部分求 hash，使长度不同的字符串字段可以比较
+                len = strnlen(data, len);
+            }
+            else if (key.type == TYPE_FLOAT && *reinterpret_cast<const float *>(data) == 0.0f)
+            {
+                // 0.0 与 -0.0 相等，需要落到同一个桶
+                static const char zero[sizeof(float)] = {};
+                data = zero;
+            }
+            for (int i = 0; i < len; i++)
+            {
+                h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+            }
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    bool satisfies_join_conds(const char *probe, const char *build) const
+    {
+        for (const auto &key : keys_)
+        {
+            if (compare_join_value(probe + key.left_offset, key.left_len, build + key.right_offset, key.right_len, key.type) != 0)
+            {
+                return false;
+            }
+        }
+        return std::all_of(residual_conds_.begin(), residual_conds_.end(), [&](const JoinCond &cond)
+                           { return eval_join_cond(cond, probe, build); });
+    }
+
+    void build_hash_table()
+    {
+        auto row_num = static_cast<uint32_t>(build_rows_.size() / right_len_);
+        uint64_t bucket_num = 1;
+        while (bucket_num < 2ULL * row_num)
+        {
+            bucket_num <<= 1;
+        }
+        bucket_mask_ = bucket_num - 1;
+        buckets_.assign(bucket_num, NONE);
+        chain_.assign(row_num, NONE);
+        // 倒序头插，使得桶内链表保持记录的原始顺序
+        for (uint32_t i = row_num; i-- > 0;)
+        {
+            auto &head = buckets_[hash_row(build_row(i), false, 0) & bucket_mask_];
+            chain_[i] = head;
+            head = i;
+        }
+    }
+
+    void write_partition(std::vector<std::unique_ptr<SpillFile>> &files, const char *row, size_t len, int depth, bool is_probe)
+    {
+        auto &file = files[(hash_row(row, is_probe, depth) >> 32) % files.size()];
+        if (file == nullptr)
+        {
+            file = std::make_unique<SpillFile>();
+        }
+        file->append(row, len);
+    }
+
+    void push_partitions(std::vector<std::unique_ptr<SpillFile>> &build_files, std::vector<std::unique_ptr<SpillFile>> &probe_files, int depth)
+    {
+        // 倒序压栈，使分区按编号顺序处理；任意一侧为空的分区不会产生结果
+        for (size_t i = build_files.size(); i-- > 0;)
+        {
+            if (build_files[i] != nullptr && probe_files[i] != nullptr)
+            {
+                partitions_.push_back({std::move(build_files[i]), std::move(probe_files[i]), depth});
+            }
+        }
+    }
+
+    // 取出下一个分区并在内存中建立 hash 表，分区仍超出预算时继续递归分区
+    bool next_partition()
+    {
+        while (!partitions_.empty())
+        {
+            auto partition = std::move(partitions_.back());
+            partitions_.pop_back();
+
+            build_rows_.resize(partition.build->size());
+            partition.build->rewind();
+            partition.build->read(build_rows_.data(), build_rows_.size());
+
+            if (build_rows_.size() > context_->memory_budget_ && partition.depth < HASH_JOIN_MAX_DEPTH)
+            {
+                int depth = partition.depth + 1;
+                std::vector<std::unique_ptr<SpillFile>> build_files(HASH_JOIN_PARTITIONS);
+                std::vector<std::unique_ptr<SpillFile>> probe_files(HASH_JOIN_PARTITIONS);
+                for (size_t pos = 0; pos < build_rows_.size(); pos += right_len_)
+                {
+                    write_partition(build_files, build_rows_.data() + pos, right_len_, depth, false);
+                }
+                std::vector<char>().swap(build_rows_);
+                partition.probe->rewind();
+                while (partition.probe->read(probe_row_.data(), left_len_))
+                {
+                    write_partition(probe_files, probe_row_.data(), left_len_, depth, true);
+                }
+                push_partitions(build_files, probe_files, depth);
+                continue;
+            }
+
+            build_hash_table();
+            probe_file_ = std::move(partition.probe);
+            probe_file_->rewind();
+            return true;
+        }
+        return false;
+    }
+
+    bool next_probe_row()
+    {
+        if (spilled_)
+        {
+            return probe_file_->read(probe_row_.data(), left_len_);
+        }
+        if (left_->is_end())
+        {
+            return false;
+        }
+        auto record = left_->Next();
+        memcpy(probe_row_.data(), record->data, left_len_);
+        left_->nextTuple();
+        return true;
+    }
+
+    void find_next_valid_tuple()
+    {
+        while (true)
+        {
+            while (match_ != NONE)
+            {
+                if (satisfies_join_conds(probe_row_.data(), build_row(match_)))
+                {
+                    return;
+                }
+                match_ = chain_[match_];
+            }
+            if (!next_probe_row())
+            {
+                if (!spilled_ || !next_partition())
+                {
+                    is_end_ = true;
+                    return;
+                }
+                continue;
+            }
+            match_ = buckets_[hash_row(probe_row_.data(), true, 0) & bucket_mask_];
+        }
+    }
+};
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "execution_manager_finals.h"
+#include "executor_abstract_finals.h"
+#include "executor_gap_lock_finals.h"
+#include "executor_index_scan_finals.h"
+
+// 单表、不分组的 MIN/MAX/COUNT：MIN/MAX 只读取索引范围两端的记录，COUNT 由表的记录数或索引的范围计数得到，
+// 不扫描表中的记录。输出与 AggPlanExecutor 相同，没有满足条件的记录时只有单独的 COUNT 输出 0
+class IndexAggExecutor : public AbstractExecutor
+{
+private:
+    SmManager *sm_manager_;
+    TabMeta *tab_;
+    RmFileHandle *fh_;
+    std::vector<Condition> conds_;
+    std::vector<IndexAggCol> agg_cols_;
+    Context *context_;
+    std::unique_ptr<GapLockExecutor> gap_lock_;
+    std::vector<std::unique_ptr<IndexScanExecutor>> scans_; // 与 agg_cols_ 对应，MIN/MAX 和不能由位置相减得到的 COUNT 使用
+
+    std::vector<ColMeta> output_cols_;
+    int TupleLen = 0;
+    std::vector<RmRecord> results_;
+    size_t current_index = 0;
+    bool computed_ = false;
+
+public:
+    IndexAggExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<Condition> conds, std::vector<IndexAggCol> agg_cols, Context *context)
+        : sm_manager_(sm_manager), conds_(std::move(conds)), agg_cols_(std::move(agg_cols)), context_(context)
+    {
+        tab_ = sm_manager_->db_.get_table(tab_name);
+        fh_ = sm_manager_->fhs_[tab_->fd_].get();
+        for (const auto &agg_col : agg_cols_)
+        {
+            const auto &col = agg_col.col;
+            if (col.aggFuncType == ast::COUNT)
+            {
+                // 与被计数的列编号相同，上层按编号找到这一列
+                auto &col_meta = output_cols_.emplace_back(col.tab_name, col.col_name, TYPE_INT, col.aggFuncType, sizeof(int), TupleLen, false, col.col_idx);
+                col_meta.tab_id = col.tab_id;
+            }
+            else
+            {
+                auto col_meta = col.meta(*tab_);
+                col_meta.offset = TupleLen;
+                col_meta.agg_func_type = col.aggFuncType;
+                output_cols_.push_back(col_meta);
+            }
+            TupleLen += output_cols_.back().len;
+        }
+
+        // 与其他扫描一样在构造时加间隙锁，锁冲突发生在输出表头之前
+        gap_lock_ = std::make_unique<GapLockExecutor>(sm_manager_, tab_, conds_, context_);
+        for (const auto &agg_col : agg_cols_)
+        {
+            auto type = agg_col.col.aggFuncType;
+            std::unique_ptr<IndexScanExecutor> scan;
+            if (type != ast::COUNT)
+            {
+                // MAX 反向扫描索引，第一条满足条件的记录即为结果
+                scan = std::make_unique<IndexScanExecutor>(sm_manager_, tab_->name_, conds_, agg_col.index_meta, context_, type == ast::MAX, agg_col.key_cols);
+            }
+            else if (agg_col.use_index && !is_contiguous(agg_col))
+            {
+                scan = std::make_unique<IndexScanExecutor>(sm_manager_, tab_->name_, conds_, agg_col.index_meta, context_);
+            }
+            scans_.push_back(std::move(scan));
+        }
+    }
+
+    size_t tupleLen() const override { return TupleLen; }
+
+    const std::vector<ColMeta> &cols() const override { return output_cols_; }
+
+    void beginTuple() override
+    {
+        current_index = 0;
+        if (computed_)
+        {
+            return;
+        }
+        compute();
+        computed_ = true;
+    }
+
+    void nextTuple() override
+    {
+        if (current_index < results_.size())
+        {
+            ++current_index;
+        }
+    }
+
+    std::unique_ptr<RmRecord> Next() override
+    {
+        if (is_end())
+        {
+            return nullptr;
+        }
+        return std::make_unique<RmRecord>(results_[current_index]);
+    }
+
+    bool is_end() const override { return current_index >= results_.size(); }
+
+private:
+    void compute()
+    {
+        RmRecord record(TupleLen);
+        bool empty = false;
+        for (size_t i = 0; i < agg_cols_.size(); i++)
+        {
+            const auto &agg_col = agg_cols_[i];
+            char *dest = record.data + output_cols_[i].offset;
+            auto &scan = scans_[i];
+            if (agg_col.col.aggFuncType == ast::COUNT)
+            {
+                int count = static_cast<int>(scan != nullptr ? count_scan(*scan) : agg_col.use_index ? count_range(agg_col) : row_num());
+                memcpy(dest, &count, sizeof(count));
+                empty |= count == 0;
+                continue;
+            }
+            scan->beginTuple();
+            if (scan->is_end())
+            {
+                empty = true;
+                continue;
+            }
+            const auto &col = agg_col.col.meta(*tab_);
+            memcpy(dest, scan->rid() + col.offset, col.len);
+        }
+        if (!empty || (agg_cols_.size() == 1 && agg_cols_[0].col.aggFuncType == ast::COUNT))
+        {
+            results_.push_back(std::move(record));
+        }
+    }
+
+    // 表中的记录数，与顺序扫描一样，记录列表不维护时使用第一个索引
+    size_t row_num()
+    {
+        if (!tab_->indexes.empty() && fh_->ban)
+        {
+            return sm_manager_->ihs_[tab_->indexes.begin()->fd_]->count();
+        }
+        return fh_->records.size();
+    }
+
+    // 条件只涉及索引的前 key_cols 列，前面的列取唯一值时满足条件的记录在索引中连续
+    bool is_contiguous(const IndexAggCol &agg_col) const
+    {
+        auto gap = gap_lock_->gap;
+        const auto &index_cols = agg_col.index_meta.cols_;
+        for (size_t i = 0; i + 1 < agg_col.key_cols; i++)
+        {
+            const auto &col = tab_->cols[index_cols[i].idx];
+            if (!gap->lower_is_closed_[col.idx] || !gap->upper_is_closed_[col.idx] || memcmp(gap->lower_ + col.offset, gap->upper_ + col.offset, col.len) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 满足条件的记录在索引中连续，用两端的位置相减得到记录数
+    size_t count_range(const IndexAggCol &agg_col)
+    {
+        auto ih = sm_manager_->ihs_[agg_col.index_meta.fd_].get();
+        auto gap = gap_lock_->gap;
+        const auto &index_cols = agg_col.index_meta.cols_;
+        size_t range_col = agg_col.key_cols - 1;
+
+        // 下界为开区间时要跳过与下界相等的记录，范围列之后的索引列取最大值；上界为开区间时之后的列取最小值
+        const auto &range = tab_->cols[index_cols[range_col].idx];
+        std::vector<char> key(fh_->record_size);
+        bool lower_open = !gap->lower_is_closed_[range.idx];
+        memcpy(key.data(), gap->lower_, fh_->record_size);
+        if (lower_open)
+        {
+            copy_rest_cols(key.data(), gap->upper_, index_cols, range_col);
+        }
+        size_t lower = ih->rank(key.data(), lower_open);
+
+        bool upper_closed = gap->upper_is_closed_[range.idx];
+        memcpy(key.data(), gap->upper_, fh_->record_size);
+        if (!upper_closed)
+        {
+            copy_rest_cols(key.data(), gap->lower_, index_cols, range_col);
+        }
+        size_t upper = ih->rank(key.data(), upper_closed);
+        return upper > lower ? upper - lower : 0;
+    }
+
+    static void copy_rest_cols(char *key, const char *src, const std::vector<ColMeta> &index_cols, size_t range_col)
+    {
+        for (size_t i = range_col + 1; i < index_cols.size(); i++)
+        {
+            memcpy(key + index_cols[i].offset, src + index_cols[i].offset, index_cols[i].len);
+        }
+    }
+
+    static size_t count_scan(IndexScanExecutor &scan)
+    {
+        size_t count = 0;
+        for (scan.beginTuple(); !scan.is_end(); scan.nextTuple())
+        {
+            count++;
+        }
+        return count;
+    }
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "execution_join_cond_finals.h"
+#include "execution_manager_finals.h"
+#include "executor_abstract_finals.h"
+#include "executor_gap_lock_finals.h"
+#include "index/ix_memory_scan_finals.h"
+
+// index nested loop join
+// 内表（右侧）不再每条外表记录都全表扫描，而是用外表记录的连接键在内表索引上做 lower_bound/upper_bound 查找
+class IndexNestedLoopJoinExecutor : public AbstractExecutor
+{
+private:
+    std::unique_ptr<AbstractExecutor> left_; // 外表
+    TabMeta *tab_;                           // 内表
+    RmFileHandle *fh_;
+    IxIndexHandle *ih_;
+    std::unique_ptr<GapLockExecutor> gap_lock;
+    size_t left_len_;
+    std::vector<ColMeta> cols_;
+    std::vector<JoinCond> conds_;
+    int key_left_offset_ = -1; // 连接键在外表记录中的偏移
+    const ColMeta *key_col_;   // 连接键在内表中的字段，即索引的第一列
+
+    // 查找内表时使用的上下界，除连接键外的部分取自内表扫描条件确定的范围
+    std::vector<char> lower_key_;
+    std::vector<char> upper_key_;
+
+    std::unique_ptr<RmRecord> left_record_;
+    std::unique_ptr<IxScan> scan_;
+    char *rid_ = nullptr;
+    bool is_end_ = true;
+
+public:
+    IndexNestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, SmManager *sm_manager, const std::string &tab_name, const std::vector<Condition> &inner_conds, const IndexMeta &index_meta, const std::vector<Condition> &conds, Context *context) : left_(std::move(left))
+    {
+        tab_ = sm_manager->db_.get_table(tab_name);
+        fh_ = sm_manager->fhs_[tab_->fd_].get();
+        ih_ = sm_manager->ihs_[index_meta.fd_].get();
+        key_col_ = &tab_->cols[index_meta.cols_.front().idx];
+        // 与内表单独扫描时加同样的间隙锁，并用它过滤内表自身的条件
+        gap_lock = std::make_unique<GapLockExecutor>(sm_manager, tab_, inner_conds, context);
+        lower_key_.assign(gap_lock->lower_key_, gap_lock->lower_key_ + fh_->record_size);
+        upper_key_.assign(gap_lock->upper_key_, gap_lock->upper_key_ + fh_->record_size);
+
+        left_len_ = left_->tupleLen();
+        cols_ = left_->cols();
+        for (auto col : tab_->cols)
+        {
+            col.offset += left_len_;
+            cols_.push_back(col);
+        }
+
+        for (const auto &cond : conds)
+        {
+            auto join_cond = make_join_cond(left_->cols(), tab_->cols, cond.lhs_col, cond.rhs_col, cond.op);
+            if (key_left_offset_ == -1 && cond.op == OP_EQ && !join_cond.lhs.is_right && join_cond.rhs.is_right && join_cond.rhs_col_idx == key_col_->idx)
+            {
+                key_left_offset_ = join_cond.lhs.offset;
+                continue;
+            }
+            conds_.push_back(std::move(join_cond));
+        }
+        if (key_left_offset_ == -1)
+        {
+            throw RMDBError();
+        }
+    }
+
+    void beginTuple() override
+    {
+        is_end_ = false;
+        scan_.reset();
+        left_->beginTuple();
+        find_next_valid_tuple();
+    }
+
+    void nextTuple() override
+    {
+        scan_->next();
+        find_next_valid_tuple();
+    }
+
+    std::unique_ptr<RmRecord> Next() override
+    {
+        auto record = std::make_unique<RmRecord>(tupleLen());
+        memcpy(record->data, left_record_->data, left_len_);
+        memcpy(record->data + left_len_, rid_, fh_->record_size);
+        return record;
+    }
+
+    size_t tupleLen() const override { return left_len_ + fh_->record_size; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    bool is_end() const override { return is_end_; }
+
+private:
+    // 用当前外表记录的连接键定位内表索引上的范围
+    void probe()
+    {
+        const char *key = left_record_->data + key_left_offset_;
+        memcpy(lower_key_.data() + key_col_->offset, key, key_col_->len);
+        memcpy(upper_key_.data() + key_col_->offset, key, key_col_->len);
+        scan_ = std::make_unique<IxScan>(ih_->lower_bound(lower_key_.data()), ih_->upper_bound(upper_key_.data()));
+    }
+
+    void find_next_valid_tuple()
+    {
+        while (true)
+        {
+            while (scan_ != nullptr && !scan_->is_end())
+            {
+                rid_ = scan_->rid();
+                if (gap_lock->gap->overlap(rid_) && std::all_of(conds_.begin(), conds_.end(), [&](const JoinCond &cond)
+                                                                { return eval_join_cond(cond, left_record_->data, rid_); }))
+                {
+                    return;
+                }
+                scan_->next();
+            }
+            if (scan_ != nullptr)
+            {
+                left_->nextTuple();
+            }
+            if (left_->is_end())
+            {
+                is_end_ = true;
+                return;
+            }
+            left_record_ = left_->Next();
+            probe();
+        }
+    }
+};
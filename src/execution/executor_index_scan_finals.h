@@ -25,7 +25,8 @@ private:
     Context *context_;
 
 public:
-    IndexScanExecutor(SmManager *sm_manager, const std::string &tab_name, const std::vector<Condition> &conds, const IndexMeta &index_meta_, Context *context)
+    IndexScanExecutor(SmManager *sm_manager, const std::string &tab_name, const std::vector<Condition> &conds, const IndexMeta &index_meta_, Context *context,
+                      bool reverse = false, size_t order_cols = 0)
     {
         context_ = context;
         tab_ = sm_manager->db_.get_table(tab_name);
@@ -36,7 +37,14 @@ public:
 
         auto lower_position_ = ih_->lower_bound(gap_lock->lower_key_);
         auto upper_position_ = ih_->upper_bound(gap_lock->upper_key_);
-        scan_ = std::make_unique<IxScan>(lower_position_, upper_position_);
+        if (reverse)
+        {
+            scan_ = std::make_unique<IxScan>(*ih_, IxCompare(index_meta_, order_cols), lower_position_, upper_position_);
+        }
+        else
+        {
+            scan_ = std::make_unique<IxScan>(lower_position_, upper_position_);
+        }
     }
 
     void beginTuple() override
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "executor_abstract_finals.h"
+
+// LIMIT n OFFSET m：跳过儿子的前 m 条记录，最多输出 n 条，输出够了就不再向儿子取记录
+class LimitExecutor : public AbstractExecutor
+{
+private:
+    std::unique_ptr<AbstractExecutor> prev_;
+    size_t limit_;
+    size_t offset_;
+    size_t emitted_ = 0;
+
+public:
+    LimitExecutor(std::unique_ptr<AbstractExecutor> prev, size_t limit, size_t offset) : prev_(std::move(prev)), limit_(limit), offset_(offset) {}
+
+    void beginTuple() override
+    {
+        emitted_ = 0;
+        if (limit_ == 0)
+        {
+            return;
+        }
+        prev_->beginTuple();
+        for (size_t i = 0; i < offset_ && !prev_->is_end(); i++)
+        {
+            prev_->nextTuple();
+        }
+    }
+
+    void nextTuple() override
+    {
+        if (++emitted_ < limit_)
+        {
+            prev_->nextTuple();
+        }
+    }
+
+    std::unique_ptr<RmRecord> Next() override { return prev_->Next(); }
+
+    bool is_end() const override { return emitted_ >= limit_ || prev_->is_end(); }
+
+    size_t tupleLen() const override { return prev_->tupleLen(); }
+
+    const std::vector<ColMeta> &cols() const override { return prev_->cols(); }
+
+    // LIMIT 不改变记录格式，投影按儿子的类型决定字段
+    AbstractExecutor *child() const { return prev_.get(); }
+};
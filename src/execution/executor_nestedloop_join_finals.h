@@ -1,193 +1,176 @@
 #pragma once
 
+#include "execution_join_cond_finals.h"
 #include "execution_manager_finals.h"
 #include "executor_abstract_finals.h"
 
+// 内表物化的 nested loop join
+// 右儿子（内表）只扫描一次，物化到连续的内存中，每条左表记录在这块内存上依次与内表记录比较，不再经过右儿子的算子重新扫描。
+// 左表记录为外层循环，右表记录为内层循环，输出顺序与逐条扫描的 nested loop join 相同（Planner::provide_order 依赖这一点）
+// 内表超出 Context::memory_budget_ 时不再物化，改为对每条左表记录重新扫描右儿子
 class NestedLoopJoinExecutor : public AbstractExecutor
 {
 private:
     std::unique_ptr<AbstractExecutor> left_;  // 左儿子节点（需要join的表）
     std::unique_ptr<AbstractExecutor> right_; // 右儿子节点（需要join的表）
-    size_t len_;                              // join后获得的每条记录的长度
-    std::vector<ColMeta> cols_;               // join后获得的记录的字段
-    std::vector<Condition> fed_conds_;        // join条件
-    bool isEnd;
-    std::unique_ptr<RmRecord> left_record_; // 当前左表记录
+    size_t left_len_;
+    size_t right_len_;
+    std::vector<ColMeta> cols_;     // join后获得的记录的字段
+    std::vector<JoinCond> conds_;   // join条件，字段偏移取自左右儿子
+    Context *context_;
+
+    std::vector<char> inner_rows_;  // 物化后的右表记录
+    size_t inner_num_ = 0;
+    bool rescan_ = false;                   // 内表超出内存预算，每条左表记录重新扫描右儿子
+    std::unique_ptr<RmRecord> inner_record_; // 重新扫描时右儿子的当前记录
+    std::unique_ptr<RmRecord> outer_record_; // 左儿子的当前记录
+    size_t inner_idx_ = 0;
+    bool isEnd = true;
 
 public:
-    NestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, std::vector<Condition> conds) : left_(std::move(left)), right_(std::move(right)), fed_conds_(std::move(conds)), isEnd(false)
+    NestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, const std::vector<Condition> &conds, Context *context) : left_(std::move(left)), right_(std::move(right)), context_(context)
     {
-        len_ = left_->tupleLen() + right_->tupleLen();
+        left_len_ = left_->tupleLen();
+        right_len_ = right_->tupleLen();
         cols_ = left_->cols();
         auto right_cols = right_->cols();
         for (auto &col : right_cols)
         {
-            col.offset += left_->tupleLen(); // 调整右表字段偏移
+            col.offset += left_len_; // 调整右表字段偏移
         }
         cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        for (const auto &cond : conds)
+        {
+            conds_.push_back(make_join_cond(left_->cols(), right_->cols(), cond.lhs_col, cond.rhs_col, cond.op));
+        }
     }
 
     void beginTuple() override
     {
+        inner_rows_.clear();
+        rescan_ = false;
+        for (right_->beginTuple(); !right_->is_end(); right_->nextTuple())
+        {
+            auto record = right_->Next();
+            inner_rows_.insert(inner_rows_.end(), record->data, record->data + right_len_);
+            if (inner_rows_.size() > context_->memory_budget_)
+            {
+                rescan_ = true;
+                std::vector<char>().swap(inner_rows_);
+                break;
+            }
+        }
+        inner_num_ = inner_rows_.size() / right_len_;
+
+        isEnd = !rescan_ && inner_num_ == 0;
+        if (isEnd)
+        {
+            return;
+        }
         left_->beginTuple();
-        right_->beginTuple();
-        if (left_->is_end())
+        isEnd = left_->is_end();
+        if (isEnd)
         {
-            isEnd = true;
             return;
         }
-        left_record_ = left_->Next();
-
-        // 初始化时找到第一个符合条件的记录组合
+        outer_record_ = left_->Next();
+        rewind_inner();
         find_next_valid_tuple();
     }
 
-    void find_next_valid_tuple()
+    void nextTuple() override
     {
-        while (!left_->is_end())
+        if (rescan_)
         {
-            while (!right_->is_end())
-            {
-                auto right_record = right_->Next();
-                if (right_record && satisfies_join_conds(left_record_.get(), right_record.get()))
-                {
-                    // 找到第一个符合条件的记录组合，退出
-                    return;
-                }
-                right_->nextTuple();
-            }
-            right_->beginTuple(); // 重置右表的迭代器
-            left_->nextTuple();   // 移动到左表的下一条记录
-            if (!left_->is_end())
-            {
-                left_record_ = left_->Next(); // 获取左表的新记录
-            }
+            right_->nextTuple();
+        }
+        else
+        {
+            inner_idx_++;
         }
-        isEnd = true; // 如果所有可能的记录组合都已检查完毕
-    }
-
-    void nextTuple() override
-    {
-        right_->nextTuple();
         find_next_valid_tuple();
     }
 
     std::unique_ptr<RmRecord> Next() override
     {
-        while (!is_end())
-        {
-            auto right_record = right_->Next();
-            if (right_record && satisfies_join_conds(left_record_.get(), right_record.get()))
-            {
-                // 如果满足连接条件，合并记录并返回
-                return merge_records(left_record_.get(), right_record.get());
-            }
-            nextTuple(); // 移动到下一个有效记录组合
-        }
-        return nullptr;
+        auto record = std::make_unique<RmRecord>(tupleLen());
+        memcpy(record->data, outer_record_->data, left_len_);
+        memcpy(record->data + left_len_, rescan_ ? inner_record_->data : inner_row(inner_idx_), right_len_);
+        return record;
     }
 
-    bool satisfies_join_conds(const RmRecord *left, const RmRecord *right) const
+    size_t tupleLen() const override
     {
-        // 检查所有连接条件是否都满足
-        return std::all_of(fed_conds_.begin(), fed_conds_.end(), [&](const Condition &cond)
-                           { return evaluate_cond(left, right, cond); });
+        return left_len_ + right_len_; // 返回左右节点的记录长度之和
     }
 
-    std::unique_ptr<RmRecord> merge_records(const RmRecord *left, const RmRecord *right)
+    const std::vector<ColMeta> &cols() const override
     {
-        auto combined = std::make_unique<RmRecord>();
-        combined->data = new char[len_];
-        std::memcpy(combined->data, left->data, left_->tupleLen());
-        std::memcpy(combined->data + left_->tupleLen(), right->data, right_->tupleLen());
-        return combined;
+        return cols_; // 直接返回已经合并和调整过的列元数据
     }
 
-    static bool evaluate_cond(const RmRecord *left, const RmRecord *right, const Condition &cond)
+    bool is_end() const override
     {
-        // 获取左侧字段数据
-        char *lhs_buf = left->data + cond.lhs.offset;
-        char *rhs_buf = right->data + cond.rhs.offset;
+        return isEnd; // 返回当前联接操作的结束状态
+    }
 
-        // 根据列的类型来比较数据
-        switch (cond.lhs.type)
-        {
-        case TYPE_INT:
+private:
+    const char *inner_row(size_t idx) const { return inner_rows_.data() + idx * right_len_; }
+
+    // 内表回到第一条记录
+    void rewind_inner()
+    {
+        inner_idx_ = 0;
+        if (rescan_)
         {
-            int lhs_value = *reinterpret_cast<int *>(lhs_buf);
-            int rhs_value = cond.is_rhs_val ? cond.rhs_val.int_val : *reinterpret_cast<int *>(rhs_buf);
-            switch (cond.op)
-            {
-            case OP_EQ:
-                return lhs_value == rhs_value;
-            case OP_LT:
-                return lhs_value < rhs_value;
-            case OP_LE:
-                return lhs_value <= rhs_value;
-            case OP_GT:
-                return lhs_value > rhs_value;
-            case OP_GE:
-                return lhs_value >= rhs_value;
-            }
-            break;
+            right_->beginTuple();
         }
-        case TYPE_FLOAT:
+    }
+
+    bool match(const char *outer, const char *inner) const
+    {
+        return std::all_of(conds_.begin(), conds_.end(), [&](const JoinCond &cond)
+                           { return eval_join_cond(cond, outer, inner); });
+    }
+
+    // 从内表的当前位置起找与 outer 匹配的记录，内表读完时返回 false
+    bool match_inner(const char *outer)
+    {
+        if (!rescan_)
         {
-            float lhs_value = *reinterpret_cast<float *>(lhs_buf);
-            float rhs_value = cond.is_rhs_val ? cond.rhs_val.float_val : *reinterpret_cast<float *>(rhs_buf);
-            switch (cond.op)
+            for (; inner_idx_ < inner_num_; inner_idx_++)
             {
-            case OP_EQ:
-                return lhs_value == rhs_value;
-            case OP_LT:
-                return lhs_value < rhs_value;
-            case OP_LE:
-                return lhs_value <= rhs_value;
-            case OP_GT:
-                return lhs_value > rhs_value;
-            case OP_GE:
-                return lhs_value >= rhs_value;
+                if (match(outer, inner_row(inner_idx_)))
+                {
+                    return true;
+                }
             }
-            break;
+            return false;
         }
-        case TYPE_STRING:
+        for (; !right_->is_end(); right_->nextTuple())
         {
-            std::string lhs_value(lhs_buf, strnlen(lhs_buf, cond.lhs.len));
-            std::string rhs_value = cond.is_rhs_val ? cond.rhs_val.str_val : std::string(rhs_buf, strnlen(rhs_buf, cond.rhs.len));
-            int cmp_result = lhs_value.compare(rhs_value);
-            switch (cond.op)
+            inner_record_ = right_->Next();
+            if (match(outer, inner_record_->data))
             {
-            case OP_EQ:
-                return cmp_result == 0;
-            case OP_LT:
-                return cmp_result < 0;
-            case OP_LE:
-                return cmp_result <= 0;
-            case OP_GT:
-                return cmp_result > 0;
-            case OP_GE:
-                return cmp_result >= 0;
+                return true;
             }
-            break;
-        }
-        default:
-            return false; // 对于未知类型，返回 false
         }
-        return false; // 默认返回 false
+        return false;
     }
 
-    size_t tupleLen() const override
-    {
-        return left_->tupleLen() + right_->tupleLen(); // 返回左右节点的记录长度之和
-    }
-
-    const std::vector<ColMeta> &cols() const override
-    {
-        return cols_; // 直接返回已经合并和调整过的列元数据
-    }
-
-    bool is_end() const override
+    // 从当前的左表记录和内表位置起找下一对匹配的记录，当前左表记录的内表读完后换下一条左表记录
+    void find_next_valid_tuple()
     {
-        return isEnd; // 返回当前联接操作的结束状态
+        while (!match_inner(outer_record_->data))
+        {
+            left_->nextTuple();
+            if (left_->is_end())
+            {
+                isEnd = true; // 如果所有可能的记录组合都已检查完毕
+                return;
+            }
+            outer_record_ = left_->Next();
+            rewind_inner();
+        }
     }
 };
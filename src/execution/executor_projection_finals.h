@@ -6,8 +6,12 @@
 #include "execution_merge_join_finals.h"
 #include "execution_sort_finals.h"
 #include "executor_abstract_finals.h"
+#include "executor_hash_join_finals.h"
+#include "executor_index_nestedloop_join_finals.h"
 #include "executor_index_scan_finals.h"
+#include "executor_limit_finals.h"
 #include "executor_seq_scan_finals.h"
+#include "executor_top_n_finals.h"
 
 class ProjectionExecutor : public AbstractExecutor
 {
@@ -31,15 +35,25 @@ public:
 
     const std::vector<ColMeta> &cols() const override
     {
-        if (dynamic_cast<IndexScanExecutor *>(prev_.get()) != nullptr)
+        // LIMIT 不改变记录格式，按它的儿子判断
+        auto prev = prev_.get();
+        if (auto limit = dynamic_cast<LimitExecutor *>(prev))
+            prev = limit->child();
+        if (dynamic_cast<IndexScanExecutor *>(prev) != nullptr)
             return cols_;
-        else if (dynamic_cast<NestedLoopJoinExecutor *>(prev_.get()) != nullptr)
+        else if (dynamic_cast<NestedLoopJoinExecutor *>(prev) != nullptr)
             return cols_;
-        else if (dynamic_cast<MergeJoinExecutor *>(prev_.get()) != nullptr)
+        else if (dynamic_cast<MergeJoinExecutor *>(prev) != nullptr)
             return cols_;
-        else if (dynamic_cast<SeqScanExecutor *>(prev_.get()) != nullptr)
+        else if (dynamic_cast<HashJoinExecutor *>(prev) != nullptr)
             return cols_;
-        else if (dynamic_cast<SortExecutor *>(prev_.get()) != nullptr)
+        else if (dynamic_cast<IndexNestedLoopJoinExecutor *>(prev) != nullptr)
+            return cols_;
+        else if (dynamic_cast<SeqScanExecutor *>(prev) != nullptr)
+            return cols_;
+        else if (dynamic_cast<SortExecutor *>(prev) != nullptr)
+            return cols_;
+        else if (dynamic_cast<TopNExecutor *>(prev) != nullptr)
             return cols_;
         else
             return prev_->cols();
@@ -4,10 +4,73 @@
 #include <string>
 #include <vector>
 
+#include "common/thread_pool_finals.h"
 #include "execution_manager_finals.h"
 #include "executor_abstract_finals.h"
+#include "executor_gap_lock_finals.h"
+#include "index/ix_memory_scan_finals.h"
 #include "record/rm_scan_finals.h"
 
+// 按 SIMD_FILTER_BATCH 条一批过滤记录数组，只输出满足范围条件的记录；批的结果在用到时才计算，LIMIT 提前结束时不会过滤整张表
+// 区域映射表明整块记录都不满足条件时跳过该块
+// 第 begin 条记录所在的块中是否可能有满足条件的记录
+inline bool zone_overlap(const ZoneMap &zone_map, const Gap &gap, size_t begin)
+{
+    size_t block = begin / ZONE_MAP_ROWS;
+    return block >= zone_map.block_num() || gap.overlap_zone(zone_map.min(block), zone_map.max(block));
+}
+
+class GapFilterScan : public RecScan
+{
+    const std::vector<char *> &records_;
+    size_t row_num_;
+    const Gap *gap_;
+    const ZoneMap &zone_map_;
+    size_t batch_begin_ = 0;
+    uint64_t mask_ = 0;
+
+public:
+    GapFilterScan(const std::vector<char *> &records, const Gap *gap, const ZoneMap &zone_map)
+        : records_(records), row_num_(records.size()), gap_(gap), zone_map_(zone_map)
+    {
+        load_batch();
+    }
+
+    void next() override
+    {
+        mask_ &= mask_ - 1;
+        if (mask_ == 0)
+        {
+            batch_begin_ += simd_filter::SIMD_FILTER_BATCH;
+            load_batch();
+        }
+    }
+
+    bool is_end() const override { return batch_begin_ >= row_num_; }
+
+    char *rid() const override { return records_[batch_begin_ + __builtin_ctzll(mask_)]; }
+
+private:
+    // 找到下一个有满足条件记录的批
+    void load_batch()
+    {
+        for (; batch_begin_ < row_num_; batch_begin_ += simd_filter::SIMD_FILTER_BATCH)
+        {
+            if (batch_begin_ % ZONE_MAP_ROWS == 0 && !zone_overlap(zone_map_, *gap_, batch_begin_))
+            {
+                batch_begin_ += ZONE_MAP_ROWS - simd_filter::SIMD_FILTER_BATCH;
+                continue;
+            }
+            size_t n = std::min(simd_filter::SIMD_FILTER_BATCH, row_num_ - batch_begin_);
+            mask_ = gap_->overlap_batch(records_.data() + batch_begin_, n);
+            if (mask_ != 0)
+            {
+                return;
+            }
+        }
+    }
+};
+
 class SeqScanExecutor : public AbstractExecutor
 {
 private:
@@ -24,6 +87,9 @@ private:
 
     std::unique_ptr<GapLockExecutor> gap_lock;
     Context *context_;
+    bool prefiltered_ = false; // scan_ 中的记录已经过滤过
+    size_t row_limit_ = SIZE_MAX; // LIMIT 下推：上层最多需要的记录数，达到后扫描提前结束
+    size_t emitted_ = 0;
 
 public:
     SeqScanExecutor(SmManager *sm_manager, std::string tab_name, const std::vector<Condition> &conds, Context *context) : tab_name_(std::move(tab_name)), sm_manager_(sm_manager)
@@ -43,17 +109,37 @@ public:
 
     const std::vector<ColMeta> &cols() const override { return *cols_; }
 
+    void set_row_limit(size_t row_limit) { row_limit_ = row_limit; }
+
     void beginTuple() override
     {
+        emitted_ = 0;
         // 初始化扫描表
         if (!tab_->indexes.empty() && fh_->ban)
         {
             auto ih_ = sm_manager_->ihs_[tab_->indexes.begin()->fd_].get();
             scan_ = std::make_unique<IxScan>(ih_->begin(), ih_->end());
+            prefiltered_ = false;
+        }
+        else if (can_parallel_scan() && row_limit_ == SIZE_MAX) // 有 LIMIT 时只需要前几条记录，不预先过滤整张表
+        {
+            // 各 morsel 并行过滤，结果按 morsel 顺序拼接，保持与串行扫描相同的顺序；之后的算子仍在当前线程中逐条读取。
+            // 只有并行聚合（AggPlanExecutor）通过 parallel_scan 在扫描线程中直接消费记录
+            std::vector<std::vector<char *>> selected((fh_->records.size() + MORSEL_ROWS - 1) / MORSEL_ROWS);
+            parallel_scan([&](size_t idx, char *rid, size_t)
+                          { selected[idx / MORSEL_ROWS].push_back(rid); });
+            std::vector<char *> rids;
+            for (auto &morsel : selected)
+            {
+                rids.insert(rids.end(), morsel.begin(), morsel.end());
+            }
+            scan_ = std::make_unique<RidListScan>(std::move(rids));
+            prefiltered_ = true;
         }
         else
         {
-            scan_ = std::make_unique<RmScan>(fh_);
+            scan_ = std::make_unique<GapFilterScan>(fh_->records, gap_lock->gap, fh_->zone_map());
+            prefiltered_ = true;
         }
 
         find_next_valid_tuple();
@@ -61,23 +147,61 @@ public:
 
     void nextTuple() override
     {
+        if (++emitted_ >= row_limit_)
+        {
+            return;
+        }
         scan_->next();
         find_next_valid_tuple();
     }
 
     std::unique_ptr<RmRecord> Next() override { return fh_->get_record(rid_); }
 
-    bool is_end() const override { return scan_->is_end(); }
+    bool is_end() const override { return emitted_ >= row_limit_ || scan_->is_end(); }
 
     char *rid() const override { return rid_; }
 
+    // 记录足够多时才值得并行扫描；ban 之后记录只保存在索引中，不能按下标划分
+    bool can_parallel_scan() const
+    {
+        return ThreadPool::instance().worker_num() > 1 && (tab_->indexes.empty() || !fh_->ban) &&
+               fh_->records.size() >= PARALLEL_SCAN_MIN_ROWS;
+    }
+
+    // 把记录数组切成 morsel 交给线程池，各线程领取 morsel 并过滤，只对满足条件的记录调用 consume(idx, rid, worker)
+    // idx 为记录在串行扫描中的下标，worker 相同的调用不会并发执行
+    template <typename Consume>
+    void parallel_scan(Consume &&consume) const
+    {
+        auto &records = fh_->records;
+        size_t row_num = records.size();
+        const auto &zone_map = fh_->zone_map();
+        ThreadPool::instance().parallel_for((row_num + MORSEL_ROWS - 1) / MORSEL_ROWS, [&](size_t morsel, size_t worker)
+                                            {
+            size_t end = std::min(row_num, (morsel + 1) * MORSEL_ROWS);
+            for (size_t begin = morsel * MORSEL_ROWS; begin < end; begin += simd_filter::SIMD_FILTER_BATCH)
+            {
+                if (begin % ZONE_MAP_ROWS == 0 && !zone_overlap(zone_map, *gap_lock->gap, begin))
+                {
+                    begin += ZONE_MAP_ROWS - simd_filter::SIMD_FILTER_BATCH;
+                    continue;
+                }
+                size_t n = std::min(simd_filter::SIMD_FILTER_BATCH, end - begin);
+                for (uint64_t mask = gap_lock->gap->overlap_batch(records.data() + begin, n); mask != 0; mask &= mask - 1)
+                {
+                    size_t idx = begin + __builtin_ctzll(mask);
+                    consume(idx, records[idx], worker);
+                }
+            } });
+    }
+
 private:
     void find_next_valid_tuple()
     {
         while (!scan_->is_end())
         {
             rid_ = scan_->rid();
-            if (gap_lock->gap->overlap(rid_))
+            if (prefiltered_ || gap_lock->gap->overlap(rid_))
             {
                 return;
             }
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "execution_sort_key_finals.h"
+#include "executor_abstract_finals.h"
+
+// ORDER BY ... LIMIT n：只保留排序后的前 n 条记录
+// 用大小不超过 n 的大顶堆保存当前最小的 n 条，新记录比堆顶小时替换堆顶；键相同时先到的记录排在前面
+class TopNExecutor : public AbstractExecutor
+{
+private:
+    std::unique_ptr<AbstractExecutor> prev_;
+    SortKeyEncoder encoder_;
+    size_t key_len_;
+    size_t len_;
+    size_t n_;
+
+    // 每个槽位保存 [规范化键 | 记录]，seqs_ 为记录在儿子输出中的序号
+    std::vector<char> slots_;
+    std::vector<size_t> seqs_;
+    std::vector<uint32_t> heap_;  // 槽位编号组成的大顶堆，排序完成后按输出顺序排列
+    bool sorted_ = false;
+    size_t current_index = 0;
+
+public:
+    TopNExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols, const std::vector<bool> &is_descs, size_t n)
+        : prev_(std::move(prev)), n_(n)
+    {
+        std::vector<SortKeyCol> key_cols;
+        for (size_t i = 0; i < sel_cols.size(); i++)
+        {
+            auto col = get_col(prev_->cols(), sel_cols[i]);
+            key_cols.push_back({col->offset, col->len, col->type, is_descs[i]});
+        }
+        encoder_ = SortKeyEncoder(std::move(key_cols));
+        key_len_ = encoder_.key_len();
+        len_ = prev_->tupleLen();
+    }
+
+    void beginTuple() override
+    {
+        current_index = 0;
+        if (sorted_)
+            return;
+        collect();
+        sorted_ = true;
+    }
+
+    void nextTuple() override
+    {
+        if (current_index < heap_.size())
+        {
+            ++current_index;
+        }
+    }
+
+    std::unique_ptr<RmRecord> Next() override
+    {
+        if (is_end())
+        {
+            return nullptr;
+        }
+        return std::make_unique<RmRecord>(slot(heap_[current_index]) + key_len_, len_);
+    }
+
+    bool is_end() const override { return current_index >= heap_.size(); }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return prev_->cols(); }
+
+private:
+    char *slot(uint32_t idx) { return slots_.data() + idx * (key_len_ + len_); }
+
+    const char *slot(uint32_t idx) const { return slots_.data() + idx * (key_len_ + len_); }
+
+    bool less(uint32_t a, uint32_t b) const
+    {
+        int res = memcmp(slot(a), slot(b), key_len_);
+        return res < 0 || (res == 0 && seqs_[a] < seqs_[b]);
+    }
+
+    void collect()
+    {
+        if (n_ == 0)
+        {
+            return;
+        }
+        auto cmp = [this](uint32_t a, uint32_t b)
+        { return less(a, b); };
+        size_t entry_len = key_len_ + len_;
+        std::vector<char> key(key_len_);
+        size_t seq = 0;
+        for (prev_->beginTuple(); !prev_->is_end(); prev_->nextTuple(), seq++)
+        {
+            auto record = prev_->Next();
+            if (heap_.size() < n_)
+            {
+                auto idx = static_cast<uint32_t>(heap_.size());
+                slots_.resize(slots_.size() + entry_len);
+                encoder_.encode(record->data, slot(idx));
+                memcpy(slot(idx) + key_len_, record->data, len_);
+                seqs_.push_back(seq);
+                heap_.push_back(idx);
+                std::push_heap(heap_.begin(), heap_.end(), cmp);
+                continue;
+            }
+            // 键不小于堆顶（序号更大，键相同时也排在后面）的记录一定不在前 n 条中
+            encoder_.encode(record->data, key.data());
+            if (memcmp(key.data(), slot(heap_.front()), key_len_) >= 0)
+            {
+                continue;
+            }
+            std::pop_heap(heap_.begin(), heap_.end(), cmp);
+            auto idx = heap_.back();
+            memcpy(slot(idx), key.data(), key_len_);
+            memcpy(slot(idx) + key_len_, record->data, len_);
+            seqs_[idx] = seq;
+            std::push_heap(heap_.begin(), heap_.end(), cmp);
+        }
+        std::sort_heap(heap_.begin(), heap_.end(), cmp);
+    }
+};
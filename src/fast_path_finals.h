@@ -0,0 +1,256 @@
+#pragma once
+
+#include <strings.h>
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "portal_finals.h"
+
+// 常见语句的快速路径：INSERT INTO t VALUES (...) 和 SELECT ... FROM t WHERE col = v（col 是某个索引的第一列）
+// 单遍扫描语句文本，直接生成 InsertExecutor 或 Projection + IndexScan 算子，不经过 flex/bison、AST、Analyze 和 Planner。
+// 形式不符合、表或列不存在、常量需要类型转换等情况都返回 nullptr，交给完整的解析流程处理（包括报错），
+// 因此快速路径生成的算子与完整流程生成的相同，输出也相同
+class FastPath
+{
+public:
+    explicit FastPath(SmManager *sm_manager) : sm_manager_(sm_manager) {}
+
+    // 语句是支持的形式时返回算子树，否则返回 nullptr；与 Portal::start 一样，INSERT 在生成算子时完成插入
+    std::shared_ptr<PortalStmt> start(const char *sql, Context *context)
+    {
+        Cursor cur{sql};
+        if (cur.keyword("INSERT"))
+        {
+            return start_insert(cur, context);
+        }
+        if (cur.keyword("SELECT"))
+        {
+            return start_select(cur, context);
+        }
+        return nullptr;
+    }
+
+    // 语句是否以关键字 kw 开头（不识别开头的注释）
+    static bool starts_with(const char *sql, const char *kw)
+    {
+        Cursor cur{sql};
+        return cur.keyword(kw);
+    }
+
+private:
+    // 语句文本上的游标，记号的写法与 lex.l 相同；匹配失败时不前进
+    struct Cursor
+    {
+        const char *p;
+
+        static bool is_ident_char(char c) { return isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+
+        void skip_space()
+        {
+            while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+            {
+                p++;
+            }
+        }
+
+        // 关键字不区分大小写，后面不能紧跟标识符的字符
+        bool keyword(const char *kw)
+        {
+            skip_space();
+            size_t len = strlen(kw);
+            if (strncasecmp(p, kw, len) != 0 || is_ident_char(p[len]))
+            {
+                return false;
+            }
+            p += len;
+            return true;
+        }
+
+        bool symbol(char c)
+        {
+            skip_space();
+            if (*p != c)
+            {
+                return false;
+            }
+            p++;
+            return true;
+        }
+
+        // {alpha}(_|{alpha}|{digit})*；与关键字同名的标识符不会是已有的表名或列名，由调用者查元数据排除
+        bool identifier(std::string &name)
+        {
+            skip_space();
+            if (!isalpha(static_cast<unsigned char>(*p)))
+            {
+                return false;
+            }
+            const char *begin = p;
+            while (is_ident_char(*p))
+            {
+                p++;
+            }
+            name.assign(begin, p);
+            return true;
+        }
+
+        // value_int、value_float、value_string，转换方式与 lex.l 相同（atoi、atof）
+        bool value(Value &val)
+        {
+            skip_space();
+            if (*p == '\'')
+            {
+                const char *end = strchr(p + 1, '\'');
+                if (end == nullptr)
+                {
+                    return false;
+                }
+                val.set_str(std::string(p + 1, end));
+                p = end + 1;
+                return true;
+            }
+            const char *q = *p == '+' || *p == '-' ? p + 1 : p;
+            if (!isdigit(static_cast<unsigned char>(*q)))
+            {
+                return false;
+            }
+            while (isdigit(static_cast<unsigned char>(*q)))
+            {
+                q++;
+            }
+            bool is_float = *q == '.';
+            if (is_float)
+            {
+                for (q++; isdigit(static_cast<unsigned char>(*q)); q++)
+                {
+                }
+            }
+            // 1e5、12abc 这类写法交给完整的解析器
+            if (is_ident_char(*q))
+            {
+                return false;
+            }
+            if (is_float)
+            {
+                val.set_float(static_cast<float>(atof(p)));
+            }
+            else
+            {
+                val.set_int(atoi(p));
+            }
+            p = q;
+            return true;
+        }
+    };
+
+    // INSERT INTO tbName VALUES '(' value {',' value} ')' ';'
+    std::shared_ptr<PortalStmt> start_insert(Cursor &cur, Context *context)
+    {
+        std::string tab_name;
+        if (!cur.keyword("INTO") || !cur.identifier(tab_name) || !cur.keyword("VALUES") || !cur.symbol('('))
+        {
+            return nullptr;
+        }
+        std::vector<Value> values;
+        do
+        {
+            if (!cur.value(values.emplace_back()))
+            {
+                return nullptr;
+            }
+        } while (cur.symbol(','));
+        if (!cur.symbol(')') || !cur.symbol(';') || !sm_manager_->db_.is_table(tab_name) ||
+            values.size() != sm_manager_->db_.get_table(tab_name)->cols.size())
+        {
+            return nullptr;
+        }
+        std::unique_ptr<AbstractExecutor> root = std::make_unique<InsertExecutor>(sm_manager_, tab_name, values, context);
+        return std::make_shared<PortalStmt>(PORTAL_DML_WITHOUT_SELECT, std::vector<TabCol>(), std::move(root), nullptr);
+    }
+
+    // SELECT ('*' | colName {',' colName}) FROM tbName WHERE colName '=' value ';'
+    std::shared_ptr<PortalStmt> start_select(Cursor &cur, Context *context)
+    {
+        std::vector<std::string> col_names;
+        if (!cur.symbol('*'))
+        {
+            do
+            {
+                if (!cur.identifier(col_names.emplace_back()))
+                {
+                    return nullptr;
+                }
+            } while (cur.symbol(','));
+        }
+        std::string tab_name;
+        std::string cond_col_name;
+        Value val;
+        if (!cur.keyword("FROM") || !cur.identifier(tab_name) || !cur.keyword("WHERE") || !cur.identifier(cond_col_name) ||
+            !cur.symbol('=') || !cur.value(val) || !cur.symbol(';') || !sm_manager_->db_.is_table(tab_name))
+        {
+            return nullptr;
+        }
+
+        auto tab = sm_manager_->db_.get_table(tab_name);
+        auto cond_col = tab->cols_idx_.find(cond_col_name);
+        if (cond_col == tab->cols_idx_.end() || cond_col->second.type != val.type ||
+            (val.type == TYPE_STRING && val.str_val.size() > static_cast<size_t>(cond_col->second.len)))
+        {
+            return nullptr;
+        }
+        // 与 Planner::get_index_cols 的选择相同：第一个以该列开头的索引
+        const IndexMeta *index = nullptr;
+        for (auto &index_meta : tab->indexes)
+        {
+            if (index_meta.cols_.front().name == cond_col_name)
+            {
+                index = &index_meta;
+                break;
+            }
+        }
+        if (index == nullptr)
+        {
+            return nullptr;
+        }
+
+        std::vector<TabCol> sel_cols;
+        if (col_names.empty())
+        {
+            for (const auto &col : tab->cols)
+            {
+                sel_cols.push_back({.tab_name = col.tab_name, .col_name = col.name});
+                sel_cols.back().bind(col);
+            }
+        }
+        for (auto &col_name : col_names)
+        {
+            auto col = tab->cols_idx_.find(col_name);
+            if (col == tab->cols_idx_.end())
+            {
+                return nullptr;
+            }
+            sel_cols.push_back({.tab_name = tab_name, .col_name = std::move(col_name)});
+            sel_cols.back().bind(col->second);
+        }
+
+        Condition cond;
+        cond.lhs_col = {.tab_name = tab_name, .col_name = cond_col_name};
+        cond.lhs_col.bind(cond_col->second);
+        cond.lhs = cond_col->second;
+        cond.op = OP_EQ;
+        cond.is_rhs_val = true;
+        cond.rhs_val = std::move(val);
+        cond.rhs_val.init_raw(cond.lhs.len);
+
+        auto scan = std::make_unique<IndexScanExecutor>(sm_manager_, tab_name, std::vector<Condition>{std::move(cond)}, *index, context);
+        std::unique_ptr<AbstractExecutor> root = std::make_unique<ProjectionExecutor>(std::move(scan), sel_cols);
+        return std::make_shared<PortalStmt>(PORTAL_ONE_SELECT, std::move(sel_cols), std::move(root), nullptr);
+    }
+
+    SmManager *sm_manager_;
+};
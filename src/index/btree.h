@@ -81,12 +81,24 @@ namespace btree
         {
             size = 0;
             next = nullptr;
+            prev = nullptr;
+        }
+
+        // 设置后继叶子，同时维护后继的前驱指针，供反向遍历使用
+        void link(btree_leaf_node *next_node)
+        {
+            next = next_node;
+            if (next_node != nullptr)
+            {
+                next_node->prev = this;
+            }
         }
 
     private:
         size_t size = 0;
         key_t keys[node_limit];
         btree_leaf_node *next = nullptr;
+        btree_leaf_node *prev = nullptr;
         compare *cmp;
     };
 
@@ -111,6 +123,18 @@ namespace btree
             return *this;
         }
 
+        // 不能对 begin() 和 end() 调用
+        btree_iterator operator--()
+        {
+            if (idx == 0)
+            {
+                node = node->prev;
+                idx = node->size;
+            }
+            idx--;
+            return *this;
+        }
+
         bool operator==(const btree_iterator &other) const { return node == other.node && idx == other.idx; }
 
         key_t operator*() const { return node->keys[idx]; }
@@ -129,7 +153,7 @@ namespace btree
 
         explicit btree_mid_node(compare *c) : cmp(c) {}
 
-        btree_mid_node(compare *c, const key_t &first_value) : size(1), cmp(c)
+        btree_mid_node(compare *c, const key_t &first_value) : size(1), key_num(1), cmp(c)
         {
             sons[0] = new btree_leaf_node_t(cmp, first_value);
         }
@@ -139,6 +163,7 @@ namespace btree
             size_t idx = find_son_idx(key);
             auto son_node = sons[idx];
             son_node->insert(key);
+            ++key_num;
             if (son_node->is_full())
             {
                 auto split_node = new btree_leaf_node_t(cmp);
@@ -146,10 +171,10 @@ namespace btree
                 std::copy_backward(sons + idx + 1, sons + size, sons + size + 1);
                 ++size;
                 sons[idx + 1] = split_node;
-                sons[idx]->next = sons[idx + 1];
+                sons[idx]->link(sons[idx + 1]);
                 if (idx + 2 < size)
                 {
-                    sons[idx + 1]->next = sons[idx + 2];
+                    sons[idx + 1]->link(sons[idx + 2]);
                 }
             }
         }
@@ -158,13 +183,14 @@ namespace btree
         {
             size_t idx = find_son_idx(key);
             auto son_node = sons[idx];
+            --key_num;
             if (son_node->size == 1)
             {
                 std::copy(sons + idx + 1, sons + size, sons + idx);
                 --size;
                 if (idx > 0)
                 {
-                    sons[idx - 1]->next = sons[idx];
+                    sons[idx - 1]->link(idx < size ? sons[idx] : son_node->next);
                 }
                 delete son_node;
             }
@@ -179,23 +205,33 @@ namespace btree
             std::copy(sons + split_prev_node_size, sons + size, new_node->sons);
             new_node->size = split_next_node_size;
             size = split_prev_node_size;
+            new_node->key_num = 0;
+            for (size_t i = 0; i < new_node->size; i++)
+            {
+                new_node->key_num += new_node->sons[i]->size;
+            }
+            key_num -= new_node->key_num;
         }
 
         bool is_full() const { return size == node_limit; }
 
+        size_t count() const { return key_num; }
+
         btree_leaf_node_t *front_leaf() const { return sons[0]; }
 
-        void set_next(btree_leaf_node_t *next_node) { sons[size - 1]->next = next_node; }
+        void set_next(btree_leaf_node_t *next_node) { sons[size - 1]->link(next_node); }
 
         btree_iterator_t begin() const { return btree_iterator_t(sons[0], 0); }
 
+        btree_iterator_t last() const { return btree_iterator_t(sons[size - 1], sons[size - 1]->size - 1); }
+
         btree_iterator_t end() const { return btree_iterator_t(sons[size - 1]->next, 0); }
 
         bool empty() const { return size == 0; }
 
         btree_iterator_t lower_bound(const key_t &key) const
         {
-            auto son = sons[find_son_idx(key)];
+            auto son = sons[find_lower_son_idx(key)];
             auto son_idx = son->lower_bound_idx(key);
             if (son_idx == son->size)
             {
@@ -232,7 +268,20 @@ namespace btree
 
         const key_t &front() const { return sons[0]->front(); }
 
+        // 小于 key（upper 为 true 时为不大于 key）的记录数
+        size_t rank(const key_t &key, bool upper) const
+        {
+            size_t idx = upper ? find_son_idx(key) : find_lower_son_idx(key);
+            size_t res = 0;
+            for (size_t i = 0; i < idx; i++)
+            {
+                res += sons[i]->size;
+            }
+            return res + (upper ? sons[idx]->upper_bound_idx(key) : sons[idx]->lower_bound_idx(key));
+        }
+
     private:
+        // 最后一个第一条记录不大于 key 的儿子
         size_t find_son_idx(const key_t &key) const
         {
             auto it = std::upper_bound(sons, sons + size, key, [this](const key_t &a, const btree_leaf_node_t *b)
@@ -241,7 +290,17 @@ namespace btree
             return idx == 0 ? 0 : idx - 1;
         }
 
+        // 最后一个第一条记录小于 key 的儿子：与 key 相等的记录可能跨越多个儿子，第一条一定不在之后的儿子中
+        size_t find_lower_son_idx(const key_t &key) const
+        {
+            auto it = std::lower_bound(sons, sons + size, key, [this](const btree_leaf_node_t *a, const key_t &b)
+                                       { return (*cmp)(a->front(), b); });
+            size_t idx = it - sons;
+            return idx == 0 ? 0 : idx - 1;
+        }
+
         size_t size = 0;
+        size_t key_num = 0; // 所有儿子中的记录数
         btree_leaf_node_t *sons[node_limit];
         compare *cmp;
     };
@@ -264,11 +323,13 @@ namespace btree
             {
                 sons[0] = new btree_mid_node_t(&cmp, key);
                 size = 1;
+                key_num = 1;
                 return;
             }
             size_t idx = find_son_idx(key);
             auto son_node = sons[idx];
             son_node->insert(key);
+            ++key_num;
             if (son_node->is_full())
             {
                 auto split_node = new btree_mid_node_t(&cmp);
@@ -293,6 +354,7 @@ namespace btree
             auto idx = find_son_idx(key);
             auto son_node = sons[idx];
             son_node->erase(key);
+            --key_num;
             if (son_node->empty())
             {
                 std::copy(sons + idx + 1, sons + size, sons + idx);
@@ -327,13 +389,23 @@ namespace btree
 
         iterator end() const { return iterator(nullptr, 0); }
 
+        // 最后一条记录，集合为空时返回 end()
+        iterator last() const
+        {
+            if (size == 0)
+            {
+                return end();
+            }
+            return sons[size - 1]->last();
+        }
+
         iterator lower_bound(const key_t &key) const
         {
             if (size == 0)
             {
                 return end();
             }
-            return sons[find_son_idx(key)]->lower_bound(key);
+            return sons[find_lower_son_idx(key)]->lower_bound(key);
         };
 
         iterator upper_bound(const key_t &key) const
@@ -354,6 +426,24 @@ namespace btree
             return sons[find_son_idx(key)]->contains(key);
         }
 
+        size_t count() const { return key_num; }
+
+        // 小于 key（upper 为 true 时为不大于 key）的记录数，只累加根节点与一个中间节点中各儿子的记录数，不遍历记录
+        size_t rank(const key_t &key, bool upper) const
+        {
+            if (size == 0)
+            {
+                return 0;
+            }
+            size_t idx = upper ? find_son_idx(key) : find_lower_son_idx(key);
+            size_t res = 0;
+            for (size_t i = 0; i < idx; i++)
+            {
+                res += sons[i]->count();
+            }
+            return res + sons[idx]->rank(key, upper);
+        }
+
     private:
         size_t find_son_idx(const key_t &key) const
         {
@@ -363,7 +453,16 @@ namespace btree
             return idx == 0 ? 0 : idx - 1;
         }
 
+        size_t find_lower_son_idx(const key_t &key) const
+        {
+            auto it = std::lower_bound(sons, sons + size, key, [this](const btree_mid_node_t *a, const key_t &b)
+                                       { return cmp(a->front(), b); });
+            size_t idx = it - sons;
+            return idx == 0 ? 0 : idx - 1;
+        }
+
         size_t size = 0;
+        size_t key_num = 0;
         btree_mid_node_t *sons[root_node_size];
         compare cmp;
     };
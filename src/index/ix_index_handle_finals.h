@@ -22,6 +22,9 @@ public:
 
     explicit IxCompare(const IndexMeta &index_meta) : cols(index_meta.cols_) {}
 
+    // 只比较索引的前 col_num 列
+    IxCompare(const IndexMeta &index_meta, size_t col_num) : cols(index_meta.cols_.begin(), index_meta.cols_.begin() + col_num) {}
+
     bool operator()(const char *a, const char *b) const
     {
         for (const auto &col : cols)
@@ -91,4 +94,19 @@ public:
     auto begin() const { return bp_tree_.begin(); }
 
     auto end() const { return bp_tree_.end(); }
+
+    size_t count() const { return bp_tree_.count(); }
+
+    // 小于 key（upper 为 true 时为不大于 key）的记录数
+    size_t rank(char *key, bool upper) const { return bp_tree_.rank(key, upper); }
+
+    // it 的前一条记录，it 为 end() 时返回最后一条记录
+    rmdb_btree::iterator prev(rmdb_btree::iterator it) const
+    {
+        if (it == bp_tree_.end())
+        {
+            return bp_tree_.last();
+        }
+        return --it;
+    }
 };
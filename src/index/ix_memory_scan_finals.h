@@ -4,11 +4,19 @@
 
 #include "ix_index_handle_finals.h"
 
+// 扫描索引 [lower_key, upper_key) 范围内的记录
 class IxScan : public RecScan
 {
 private:
     rmdb_btree::iterator it, end;
 
+    // 反向扫描时把 group_cmp_ 比较的列都相同的记录分为一组，各组从后向前输出，组内仍按索引中的顺序输出，
+    // 与对正向扫描的结果按这些列做稳定的降序排序一致。当前组为 [group_begin_, group_end_)
+    const IxIndexHandle *ih_ = nullptr;
+    IxCompare group_cmp_;
+    rmdb_btree::iterator group_begin_, group_end_;
+    bool reverse_end_ = false;
+
 public:
     IxScan(const rmdb_btree::iterator &lower_key, const rmdb_btree::iterator &upper_key)
     {
@@ -16,9 +24,52 @@ public:
         end = upper_key;
     }
 
-    void next() override { ++it; }
+    // 从 upper_key 向 lower_key 反向扫描，记录按索引的降序输出
+    IxScan(const IxIndexHandle &ih, IxCompare group_cmp, const rmdb_btree::iterator &lower_key, const rmdb_btree::iterator &upper_key)
+        : ih_(&ih), group_cmp_(std::move(group_cmp))
+    {
+        end = lower_key;
+        group_begin_ = upper_key;
+        prev_group();
+    }
+
+    void next() override
+    {
+        if (ih_ == nullptr)
+        {
+            ++it;
+            return;
+        }
+        if (++it == group_end_)
+        {
+            prev_group();
+        }
+    }
 
-    bool is_end() const override { return it == end; }
+    bool is_end() const override { return ih_ == nullptr ? it == end : reverse_end_; }
 
     char *rid() const override { return *it; }
+
+private:
+    // 定位到当前组之前的一组，it 指向该组的第一条记录
+    void prev_group()
+    {
+        if (group_begin_ == end)
+        {
+            reverse_end_ = true;
+            return;
+        }
+        group_end_ = group_begin_;
+        it = ih_->prev(group_end_);
+        while (!(it == end))
+        {
+            auto prev = ih_->prev(it);
+            if (group_cmp_(*prev, *it))
+            {
+                break;
+            }
+            it = prev;
+        }
+        group_begin_ = it;
+    }
 };
@@ -34,10 +34,14 @@ typedef enum PlanTag
     T_SeqScan,
     T_IndexScan,
     T_NestLoop,
-    T_SortMerge, // sort merge join
+    T_SortMerge,     // sort merge join
+    T_HashJoin,      // hash join
+    T_IndexNestLoop, // index nested loop join
     T_Sort,
+    T_Limit,
     T_Projection,
     T_Agg,
+    T_IndexAgg,
     T_Having,
     T_Create_StaticCheckPoint,
     T_Crash,
@@ -79,6 +83,9 @@ public:
     std::string tab_name_;
     std::vector<Condition> conds_;
     IndexMeta index_meta_;
+    int limit_ = -1; // LIMIT 下推：非负时上层最多需要 limit_ 条记录
+    bool reverse_ = false; // 索引扫描按索引的降序输出
+    size_t order_cols_ = 0; // 反向扫描时 order by 用到的索引前缀列数，这些列都相同的记录保持索引中的顺序
 };
 
 class JoinPlan : public Plan
@@ -140,19 +147,41 @@ public:
 class SortPlan : public Plan
 {
 public:
-    SortPlan(PlanTag tag, std::shared_ptr<Plan> subplan, TabCol sel_col, bool is_desc)
+    SortPlan(PlanTag tag, std::shared_ptr<Plan> subplan, std::vector<TabCol> sel_cols, std::vector<bool> is_descs)
     {
         Plan::tag = tag;
         subplan_ = std::move(subplan);
-        sel_col_ = std::move(sel_col);
-        is_desc_ = is_desc;
+        sel_cols_ = std::move(sel_cols);
+        is_descs_ = std::move(is_descs);
     }
 
+    SortPlan(PlanTag tag, std::shared_ptr<Plan> subplan, TabCol sel_col, bool is_desc)
+        : SortPlan(tag, std::move(subplan), std::vector<TabCol>{std::move(sel_col)}, std::vector<bool>{is_desc}) {}
+
     ~SortPlan() {}
 
     std::shared_ptr<Plan> subplan_;
-    TabCol sel_col_;
-    bool is_desc_;
+    std::vector<TabCol> sel_cols_; // 多字段排序，前面的字段优先
+    std::vector<bool> is_descs_;
+    int limit_ = -1; // 非负时只需要排序后的前 limit_ 条，使用 Top-N
+};
+
+class LimitPlan : public Plan
+{
+public:
+    LimitPlan(PlanTag tag, std::shared_ptr<Plan> subplan, int limit, int offset)
+    {
+        Plan::tag = tag;
+        subplan_ = std::move(subplan);
+        limit_ = limit;
+        offset_ = offset;
+    }
+
+    ~LimitPlan() {}
+
+    std::shared_ptr<Plan> subplan_;
+    int limit_;
+    int offset_;
 };
 
 // dml语句，包括insert; delete; update; select语句　
@@ -266,6 +295,29 @@ public:
     ~AggPlan() override = default;
 };
 
+// 不分组的 MIN/MAX/COUNT 的一个输出列：use_index 时 MIN/MAX 取索引范围内的第一条（MAX 反向扫描），
+// COUNT 用索引的范围计数；COUNT 没有条件时 use_index 为 false，直接使用表的记录数
+struct IndexAggCol
+{
+    TabCol col;
+    bool use_index;
+    IndexMeta index_meta;
+    size_t key_cols; // MIN/MAX 为扫描用到的索引前缀列数，COUNT 为条件涉及的索引前缀列数
+};
+
+// 单表、不分组、只有 MIN/MAX/COUNT 的聚合，不扫描表中的记录
+class IndexAggPlan : public Plan
+{
+public:
+    std::string tab_name_;
+    std::vector<Condition> conds_;
+    std::vector<IndexAggCol> agg_cols_;
+
+    IndexAggPlan(PlanTag tag, std::string tab_name, std::vector<Condition> conds, std::vector<IndexAggCol> agg_cols) : tab_name_(std::move(tab_name)), conds_(std::move(conds)), agg_cols_(std::move(agg_cols)) { Plan::tag = tag; }
+
+    ~IndexAggPlan() override = default;
+};
+
 class HavingPlan : public Plan
 {
 public:
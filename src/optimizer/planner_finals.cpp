@@ -87,6 +87,126 @@ bool Planner::get_merge_join_index(const std::string &tab_name, const TabCol &co
     return false;
 }
 
+bool Planner::get_join_index(const std::string &tab_name, const TabCol &col, IndexMeta &index_meta)
+{
+    auto tab_ = sm_manager_->db_.get_table(tab_name);
+    for (auto &index : tab_->indexes)
+    {
+        if (index.cols_.front().name == col.col_name)
+        {
+            index_meta = index;
+            return true;
+        }
+    }
+    return false;
+}
+
+double Planner::get_table_rows(const std::string &tab_name)
+{
+    auto tab_ = sm_manager_->db_.get_table(tab_name);
+    auto fh_ = sm_manager_->fhs_[tab_->fd_].get();
+    // ban 之后 records 不再维护，有索引时用索引中的记录数
+    if (!tab_->indexes.empty() && fh_->ban)
+    {
+        return static_cast<double>(sm_manager_->ihs_[tab_->indexes.begin()->fd_]->count());
+    }
+    return static_cast<double>(fh_->records.size());
+}
+
+// 估计计划输出的记录数，选择率沿用 System R 的默认值：等值 1/10，范围 1/3
+double Planner::estimate_rows(const std::shared_ptr<Plan> &plan)
+{
+    if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan))
+    {
+        double rows = get_table_rows(x->tab_name_);
+        for (auto &cond : x->conds_)
+        {
+            rows *= cond.op == OP_EQ ? 0.1 : 1.0 / 3;
+        }
+        return std::max(rows, 1.0);
+    }
+    if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan))
+    {
+        double left_rows = estimate_rows(x->left_);
+        double right_rows = estimate_rows(x->right_);
+        if (x->conds_.empty())
+        {
+            return left_rows * right_rows;
+        }
+        bool is_equi_join = std::any_of(x->conds_.begin(), x->conds_.end(), [](const Condition &cond)
+                                        { return !cond.is_rhs_val && cond.op == OP_EQ; });
+        return is_equi_join ? std::max(left_rows, right_rows) : left_rows * right_rows / 3;
+    }
+    return 1;
+}
+
+// 两侧需要先排序再归并，已经按连接列有序（连接列上有索引）的一侧不需要排序
+double Planner::estimate_sort_merge_cost(const std::shared_ptr<Plan> &left, const std::shared_ptr<Plan> &right, const Condition &cond)
+{
+    double cost = 0;
+    for (auto &[plan, col] : {std::make_pair(left, cond.lhs_col), std::make_pair(right, cond.rhs_col)})
+    {
+        double rows = estimate_rows(plan);
+        cost += rows;
+        auto scan = std::dynamic_pointer_cast<ScanPlan>(plan);
+        if (scan == nullptr || !get_merge_join_index(scan->tab_name_, col))
+        {
+            cost += rows * std::log2(rows + 1);
+        }
+    }
+    return cost;
+}
+
+// 为一个连接条件选择代价最低的连接方式，cost 返回所选方式的代价估计
+// nested loop join: |L|*|R|；hash join: |L|+|R|；index nested loop join: |outer|*log|inner|
+std::shared_ptr<Plan> Planner::make_join_plan(const std::shared_ptr<Plan> &left, const std::shared_ptr<Plan> &right, const Condition &cond, double &cost)
+{
+    double left_rows = estimate_rows(left);
+    double right_rows = estimate_rows(right);
+    cost = left_rows * right_rows;
+    auto join_plan = arena_make_shared<JoinPlan>(T_NestLoop, left, right, std::vector<Condition>{cond});
+    if (cond.is_rhs_val || cond.is_subquery || cond.op != OP_EQ)
+    {
+        return join_plan;
+    }
+
+    if (enable_hashjoin)
+    {
+        cost = left_rows + right_rows;
+        join_plan = arena_make_shared<JoinPlan>(T_HashJoin, left, right, std::vector<Condition>{cond});
+    }
+
+    // 内表是单表扫描且连接列是某个索引的第一列时，可以用外表记录的连接键直接查索引
+    auto try_index_join = [&](const std::shared_ptr<Plan> &outer, const TabCol &outer_col, const std::shared_ptr<Plan> &inner, const TabCol &inner_col, double outer_rows)
+    {
+        auto scan = std::dynamic_pointer_cast<ScanPlan>(inner);
+        IndexMeta index_meta;
+        if (scan == nullptr || !get_join_index(scan->tab_name_, inner_col, index_meta) ||
+            std::any_of(scan->conds_.begin(), scan->conds_.end(), [](const Condition &c)
+                        { return c.is_subquery; }))
+        {
+            return;
+        }
+        double index_cost = outer_rows * (std::log2(get_table_rows(scan->tab_name_) + 1) + 1);
+        if (index_cost < cost)
+        {
+            cost = index_cost;
+            Condition index_cond = cond;
+            index_cond.lhs_col = outer_col;
+            index_cond.rhs_col = inner_col;
+            auto inner_scan = arena_make_shared<ScanPlan>(T_IndexScan, sm_manager_, scan->tab_name_, scan->conds_, index_meta);
+            join_plan = arena_make_shared<JoinPlan>(T_IndexNestLoop, outer, std::move(inner_scan), std::vector<Condition>{std::move(index_cond)});
+        }
+    };
+    // 外表的连接键按内表字段的宽度原样拷贝进索引键，等值条件不再另外检查，两侧字段的类型和长度必须相同
+    if (cond.lhs.type == cond.rhs.type && cond.lhs.len == cond.rhs.len)
+    {
+        try_index_join(left, cond.lhs_col, right, cond.rhs_col, left_rows);
+        try_index_join(right, cond.rhs_col, left, cond.lhs_col, right_rows);
+    }
+    return join_plan;
+}
+
 std::vector<Condition> pop_conds(std::vector<Condition> &conds, const std::string &tab_names)
 {
     // auto has_tab = [&](const std::string &tab_name) {
@@ -196,6 +316,8 @@ std::shared_ptr<Plan> Planner::physical_optimization(const std::shared_ptr<Query
     plan = generate_agg_plan(query, std::move(plan));
     // 处理orderby
     plan = generate_sort_plan(query, std::move(plan));
+    // 处理limit
+    plan = generate_limit_plan(query, std::move(plan));
 
     return plan;
 }
@@ -222,11 +344,11 @@ std::shared_ptr<Plan> Planner::make_one_rel(const std::shared_ptr<Query> &query,
         auto index_meta = get_index_cols(tables[i], curr_conds);
         if (index_meta.cols_.empty())
         { // 该表没有索引
-            table_scan_executors[i] = std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, tables[i], curr_conds, index_meta);
+            table_scan_executors[i] = arena_make_shared<ScanPlan>(T_SeqScan, sm_manager_, tables[i], curr_conds, index_meta);
         }
         else
         { // 存在索引
-            table_scan_executors[i] = std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_meta);
+            table_scan_executors[i] = arena_make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_meta);
         }
     }
 
@@ -259,13 +381,19 @@ std::shared_ptr<Plan> Planner::make_one_rel(const std::shared_ptr<Query> &query,
             right = pop_scan(scantbl, it->rhs_col.tab_name, joined_tables, table_scan_executors);
             std::vector<Condition> join_conds{*it};
             // 建立join
-            //  判断使用哪种join方式
-            if (enable_nestedloop_join || enable_sortmerge_join)
+            //  判断使用哪种join方式，sort merge join 只在开启且代价更低时使用
+            double join_cost;
+            auto join_plan = make_join_plan(left, right, *it, join_cost);
+            if (join_plan->tag != T_NestLoop && (!enable_sortmerge_join || join_cost <= estimate_sort_merge_cost(left, right, *it)))
+            {
+                table_join_executors = std::move(join_plan);
+            }
+            else if (enable_nestedloop_join || enable_sortmerge_join)
             {
                 //     // 默认nested loop join
-                //     table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(left), std::move(right), join_conds);
+                //     table_join_executors = arena_make_shared<JoinPlan>(T_NestLoop, std::move(left), std::move(right), join_conds);
                 // } else if (enable_nestedloop_join) {
-                //     table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(left), std::move(right), join_conds);
+                //     table_join_executors = arena_make_shared<JoinPlan>(T_NestLoop, std::move(left), std::move(right), join_conds);
                 // } else if (enable_sortmerge_join) {
                 auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
                 TabCol left_col, right_col;
@@ -273,7 +401,7 @@ std::shared_ptr<Plan> Planner::make_one_rel(const std::shared_ptr<Query> &query,
                 // 1、左表有序
 
                 left = generate_join_sort_plan(it->lhs_col.tab_name, conds, left_col, left);
-                if (x->has_sort && x->order->cols->col_name == left_col.col_name)
+                if (x->has_sort && x->order->is_single_asc(left_col.col_name))
                 {
                     x->has_sort = false;
                 }
@@ -281,15 +409,15 @@ std::shared_ptr<Plan> Planner::make_one_rel(const std::shared_ptr<Query> &query,
                 // 2、右表有序
 
                 right = generate_join_sort_plan(it->rhs_col.tab_name, conds, right_col, right);
-                if (x->has_sort && x->order->cols->col_name == right_col.col_name)
+                if (x->has_sort && x->order->is_single_asc(right_col.col_name))
                 {
                     x->has_sort = false;
                 }
                 if (!left_col.empty() && !right_col.empty())
-                    table_join_executors = std::make_shared<JoinPlan>(T_SortMerge, std::move(left), std::move(right),
+                    table_join_executors = arena_make_shared<JoinPlan>(T_SortMerge, std::move(left), std::move(right),
                                                                       join_conds, left_col, right_col, tables);
                 else
-                    table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(left), std::move(right),
+                    table_join_executors = arena_make_shared<JoinPlan>(T_NestLoop, std::move(left), std::move(right),
                                                                       join_conds);
             }
             else
@@ -298,7 +426,7 @@ std::shared_ptr<Plan> Planner::make_one_rel(const std::shared_ptr<Query> &query,
                 throw RMDBError();
             }
 
-            // table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(left), std::move(right), join_conds);
+            // table_join_executors = arena_make_shared<JoinPlan>(T_NestLoop, std::move(left), std::move(right), join_conds);
             it = conds.erase(it);
             break;
         }
@@ -323,9 +451,9 @@ std::shared_ptr<Plan> Planner::make_one_rel(const std::shared_ptr<Query> &query,
 
             if (left_need_to_join_executors != nullptr && right_need_to_join_executors != nullptr)
             {
-                std::vector<Condition> join_conds{*it};
-                std::shared_ptr<Plan> temp_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(left_need_to_join_executors), std::move(right_need_to_join_executors), join_conds);
-                table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(temp_join_executors),
+                double join_cost;
+                std::shared_ptr<Plan> temp_join_executors = make_join_plan(left_need_to_join_executors, right_need_to_join_executors, *it, join_cost);
+                table_join_executors = arena_make_shared<JoinPlan>(T_NestLoop, std::move(temp_join_executors),
                                                                   std::move(table_join_executors),
                                                                   std::vector<Condition>());
             }
@@ -344,9 +472,8 @@ std::shared_ptr<Plan> Planner::make_one_rel(const std::shared_ptr<Query> &query,
                     it->op = swap_op.at(it->op);
                     left_need_to_join_executors = std::move(right_need_to_join_executors);
                 }
-                std::vector<Condition> join_conds{*it};
-                table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(left_need_to_join_executors),
-                                                                  std::move(table_join_executors), join_conds);
+                double join_cost;
+                table_join_executors = make_join_plan(left_need_to_join_executors, table_join_executors, *it, join_cost);
             }
             else
             {
@@ -366,7 +493,7 @@ std::shared_ptr<Plan> Planner::make_one_rel(const std::shared_ptr<Query> &query,
     {
         if (scantbl[i] == -1)
         {
-            table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(table_scan_executors[i]),
+            table_join_executors = arena_make_shared<JoinPlan>(T_NestLoop, std::move(table_scan_executors[i]),
                                                               std::move(table_join_executors),
                                                               std::vector<Condition>());
         }
@@ -387,9 +514,15 @@ std::shared_ptr<Plan> Planner::generate_agg_plan(const std::shared_ptr<Query> &q
     std::vector<TabCol> group_by_cols;
     if (x->group_by)
     {
+        auto tab = sm_manager_->db_.get_table(query->tables[0]);
         for (const auto &group_by_col : x->group_by->cols)
         {
-            group_by_cols.push_back({group_by_col->tab_name, group_by_col->col_name});
+            auto &group_col = group_by_cols.emplace_back(TabCol{group_by_col->tab_name, group_by_col->col_name});
+            auto pos = tab->cols_idx_.find(group_col.col_name);
+            if (pos != tab->cols_idx_.end())
+            {
+                group_col.bind(pos->second);
+            }
         }
     }
 
@@ -397,7 +530,7 @@ std::shared_ptr<Plan> Planner::generate_agg_plan(const std::shared_ptr<Query> &q
     std::vector<TabCol> sel_cols;
     for (const auto &col : query->cols)
     {
-        sel_cols.push_back({col.tab_name, col.col_name, col.alias, col.aggFuncType});
+        sel_cols.push_back(col);
     }
     auto &agg_sel_cols = sel_cols;
     for (const auto &cond : query->having_conds)
@@ -406,23 +539,114 @@ std::shared_ptr<Plan> Planner::generate_agg_plan(const std::shared_ptr<Query> &q
                          { return col.col_name == cond.lhs_col.col_name && col.tab_name == cond.lhs_col.tab_name &&
                                   col.aggFuncType == cond.lhs_col.aggFuncType; }) == agg_sel_cols.end())
         {
-            agg_sel_cols.push_back(
-                {cond.lhs_col.tab_name, cond.lhs_col.col_name, cond.lhs_col.alias, cond.lhs_col.aggFuncType});
+            agg_sel_cols.push_back(cond.lhs_col);
+        }
+    }
+
+    if (x->group_by == nullptr)
+    {
+        if (auto index_agg = generate_index_agg_plan(plan, agg_sel_cols))
+        {
+            return index_agg;
         }
     }
 
     // 生成聚合计划
-    plan = std::make_shared<AggPlan>(T_Agg, std::move(plan), group_by_cols, agg_sel_cols);
+    plan = arena_make_shared<AggPlan>(T_Agg, std::move(plan), group_by_cols, agg_sel_cols);
 
     // 如果有 HAVING 子句，则生成 HAVING 计划
     if (x->group_by && !x->group_by->having_conds.empty())
     {
-        plan = std::make_shared<HavingPlan>(T_Having, std::move(plan), std::move(sel_cols), query->having_conds);
+        plan = arena_make_shared<HavingPlan>(T_Having, std::move(plan), std::move(sel_cols), query->having_conds);
     }
 
     return plan;
 }
 
+// 条件是否恰好对应索引 index 中连续的一段：条件只涉及索引的前 k 列，且前 k - 1 列都有等值条件。返回 k，不满足时返回 0
+size_t Planner::index_range_cols(const IndexMeta &index, const std::vector<Condition> &conds)
+{
+    auto is_col = [](const Condition &cond, const ColMeta &col)
+    { return cond.lhs_col.refers_to(col); };
+    size_t range_cols = 0;
+    for (const auto &cond : conds)
+    {
+        auto pos = std::find_if(index.cols_.begin(), index.cols_.end(), [&](const ColMeta &col)
+                                { return is_col(cond, col); });
+        if (pos == index.cols_.end())
+        {
+            return 0;
+        }
+        range_cols = std::max<size_t>(range_cols, pos - index.cols_.begin() + 1);
+    }
+    for (size_t i = 0; i + 1 < range_cols; i++)
+    {
+        if (std::none_of(conds.begin(), conds.end(), [&](const Condition &cond)
+                         { return cond.op == OP_EQ && is_col(cond, index.cols_[i]); }))
+        {
+            return 0;
+        }
+    }
+    return range_cols;
+}
+
+// 单表、不分组且只有 MIN/MAX/COUNT 时，每一列都能由索引或表的记录数得到则不扫描记录，否则返回 nullptr
+std::shared_ptr<Plan> Planner::generate_index_agg_plan(const std::shared_ptr<Plan> &plan, const std::vector<TabCol> &sel_cols)
+{
+    auto scan = std::dynamic_pointer_cast<ScanPlan>(plan);
+    if (scan == nullptr || std::any_of(scan->conds_.begin(), scan->conds_.end(), [](const Condition &cond)
+                                       { return !cond.is_rhs_val || cond.is_subquery; }))
+    {
+        return nullptr;
+    }
+    const auto &indexes = sm_manager_->db_.get_table(scan->tab_name_)->indexes;
+    std::vector<IndexAggCol> agg_cols;
+    for (const auto &col : sel_cols)
+    {
+        IndexAggCol agg_col{col, false, {}, 0};
+        if (col.aggFuncType == ast::COUNT && !scan->conds_.empty())
+        {
+            for (const auto &index : indexes)
+            {
+                agg_col.key_cols = index_range_cols(index, scan->conds_);
+                if (agg_col.key_cols > 0)
+                {
+                    agg_col.use_index = true;
+                    agg_col.index_meta = index;
+                    break;
+                }
+            }
+            if (!agg_col.use_index)
+            {
+                return nullptr;
+            }
+        }
+        else if (col.aggFuncType == ast::MIN || col.aggFuncType == ast::MAX)
+        {
+            for (const auto &index : indexes)
+            {
+                agg_col.key_cols = index_order_cols(index, scan->conds_, {col});
+                if (agg_col.key_cols > 0)
+                {
+                    agg_col.use_index = true;
+                    agg_col.index_meta = index;
+                    break;
+                }
+            }
+            if (!agg_col.use_index)
+            {
+                return nullptr;
+            }
+        }
+        else if (col.aggFuncType != ast::COUNT)
+        {
+            return nullptr;
+        }
+        agg_cols.push_back(std::move(agg_col));
+    }
+    return arena_make_shared<IndexAggPlan>(T_IndexAgg, scan->tab_name_, scan->conds_, std::move(agg_cols));
+}
+
 std::shared_ptr<Plan> Planner::generate_sort_plan(const std::shared_ptr<Query> &query, std::shared_ptr<Plan> plan)
 {
     auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
@@ -438,13 +662,127 @@ std::shared_ptr<Plan> Planner::generate_sort_plan(const std::shared_ptr<Query> &
         const auto &sel_tab_cols = sm_manager_->db_.get_table(sel_tab_name)->cols;
         all_cols.insert(all_cols.end(), sel_tab_cols.begin(), sel_tab_cols.end());
     }
-    TabCol sel_col;
-    for (auto &col : all_cols)
+    std::vector<TabCol> sel_cols;
+    std::vector<bool> is_descs;
+    for (size_t i = 0; i < x->order->cols.size(); i++)
+    {
+        auto &order_col = x->order->cols[i];
+        TabCol sel_col;
+        for (auto &col : all_cols)
+        {
+            if (col.name == order_col->col_name && (order_col->tab_name.empty() || col.tab_name == order_col->tab_name))
+            {
+                sel_col = {.tab_name = col.tab_name, .col_name = col.name};
+                sel_col.bind(col);
+            }
+        }
+        sel_cols.push_back(sel_col);
+        is_descs.push_back(x->order->orderby_dirs[i] == ast::OrderBy_DESC);
+    }
+    // 各字段方向相同且下层已经按该顺序输出时不需要排序
+    if (std::all_of(is_descs.begin(), is_descs.end(), [&](bool is_desc)
+                    { return is_desc == is_descs.front(); }) &&
+        provide_order(plan, sel_cols, is_descs.front()))
+    {
+        return plan;
+    }
+    return arena_make_shared<SortPlan>(T_Sort, std::move(plan), std::move(sel_cols), std::move(is_descs));
+}
+
+// 按索引 index 扫描时输出是否按 sel_cols 升序：sel_cols 依次是索引列的前缀，
+// 中间可以夹着有等值条件的索引列（取值唯一，不影响之后的列的顺序）。返回用到的索引前缀列数，不满足时返回 0
+size_t Planner::index_order_cols(const IndexMeta &index, const std::vector<Condition> &conds, const std::vector<TabCol> &sel_cols)
+{
+    size_t matched = 0;
+    size_t col_num = 0;
+    for (const auto &col : index.cols_)
+    {
+        if (matched == sel_cols.size())
+        {
+            break;
+        }
+        col_num++;
+        if (sel_cols[matched].refers_to(col))
+        {
+            matched++;
+            continue;
+        }
+        bool is_eq = std::any_of(conds.begin(), conds.end(), [&](const Condition &cond)
+                                 { return cond.is_rhs_val && !cond.is_subquery && cond.op == OP_EQ &&
+                                          cond.lhs_col.refers_to(col); });
+        if (!is_eq)
+        {
+            break;
+        }
+    }
+    return matched == sel_cols.size() ? col_num : 0;
+}
+
+// 计划的输出是否已经按 sel_cols 有序（升序或 is_desc 时降序）
+// 索引扫描按索引顺序输出，顺序扫描在有合适的索引时改为索引扫描，降序时反向扫描索引；
+// nested loop join 和 index nested loop join 按外表（左儿子）的顺序输出
+bool Planner::provide_order(const std::shared_ptr<Plan> &plan, const std::vector<TabCol> &sel_cols, bool is_desc)
+{
+    if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan))
+    {
+        if (x->tag == T_NestLoop || x->tag == T_IndexNestLoop)
+        {
+            return provide_order(x->left_, sel_cols, is_desc);
+        }
+        return false;
+    }
+    auto scan = std::dynamic_pointer_cast<ScanPlan>(plan);
+    if (scan == nullptr)
+    {
+        return false;
+    }
+    size_t order_cols = scan->tag == T_IndexScan ? index_order_cols(scan->index_meta_, scan->conds_, sel_cols) : 0;
+    // 已选的索引用于过滤，不为了顺序换掉它
+    if (order_cols == 0 && scan->tag != T_IndexScan)
+    {
+        for (const auto &index : sm_manager_->db_.get_table(scan->tab_name_)->indexes)
+        {
+            order_cols = index_order_cols(index, scan->conds_, sel_cols);
+            if (order_cols > 0)
+            {
+                scan->tag = T_IndexScan;
+                scan->index_meta_ = index;
+                break;
+            }
+        }
+    }
+    if (order_cols == 0)
+    {
+        return false;
+    }
+    scan->reverse_ = is_desc;
+    scan->order_cols_ = order_cols;
+    return true;
+}
+
+std::shared_ptr<Plan> Planner::generate_limit_plan(const std::shared_ptr<Query> &query, std::shared_ptr<Plan> plan)
+{
+    auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
+    if (!x->limit)
+    {
+        return plan;
+    }
+    // 上层最多需要的记录数
+    int need = x->limit->limit + x->limit->offset;
+    if (auto sort = std::dynamic_pointer_cast<SortPlan>(plan))
+    {
+        // 前 need 条不多时用有界堆代替完整排序
+        if (need <= TOP_N_MAX_ROWS)
+        {
+            sort->limit_ = need;
+        }
+    }
+    else if (auto scan = std::dynamic_pointer_cast<ScanPlan>(plan))
     {
-        if (col.name == x->order->cols->col_name)
-            sel_col = {.tab_name = col.tab_name, .col_name = col.name};
+        // 单表无排序无聚合，扫描够 need 条后即可结束
+        scan->limit_ = need;
     }
-    return std::make_shared<SortPlan>(T_Sort, std::move(plan), sel_col, x->order->orderby_dir == ast::OrderBy_DESC);
+    return arena_make_shared<LimitPlan>(T_Limit, std::move(plan), x->limit->limit, x->limit->offset);
 }
 
 std::shared_ptr<Plan>
@@ -480,11 +818,11 @@ Planner::generate_join_sort_plan(const std::string &table, std::vector<Condition
     if (exist_index)
     {
         std::vector<std::string> index_col_names = {col.col_name};
-        return std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, scan_plan->tab_name_, scan_plan->conds_,
+        return arena_make_shared<ScanPlan>(T_IndexScan, sm_manager_, scan_plan->tab_name_, scan_plan->conds_,
                                           index_col_names);
     }
-    // 否则，返回排序计划
-    return std::make_shared<SortPlan>(T_Sort, std::move(plan), col, ast::OrderBy_DESC);
+    // 否则，返回升序的排序计划
+    return arena_make_shared<SortPlan>(T_Sort, std::move(plan), col, false);
 }
 
 std::shared_ptr<Plan> Planner::generate_select_plan(std::shared_ptr<Query> query, Context *context)
@@ -494,7 +832,7 @@ std::shared_ptr<Plan> Planner::generate_select_plan(std::shared_ptr<Query> query
     // 物理优化
     auto &sel_cols = query->cols;
     std::shared_ptr<Plan> plannerRoot = physical_optimization(query, context);
-    plannerRoot = std::make_shared<ProjectionPlan>(T_Projection, std::move(plannerRoot), std::move(sel_cols));
+    plannerRoot = arena_make_shared<ProjectionPlan>(T_Projection, std::move(plannerRoot), std::move(sel_cols));
 
     return plannerRoot;
 }
@@ -521,28 +859,28 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
                 throw RMDBError();
             }
         }
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs);
+        plannerRoot = arena_make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs);
     }
     else if (auto x = std::dynamic_pointer_cast<ast::DropTable>(query->parse))
     {
         // drop table;
-        plannerRoot = std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(),
+        plannerRoot = arena_make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(),
                                                 std::vector<ColDef>());
     }
     else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse))
     {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        plannerRoot = arena_make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
     }
     else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse))
     {
         // drop index
-        plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        plannerRoot = arena_make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
     }
     else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(query->parse))
     {
         // insert;
-        plannerRoot = std::make_shared<DMLPlan>(T_Insert, std::shared_ptr<Plan>(), x->tab_name, query->values,
+        plannerRoot = arena_make_shared<DMLPlan>(T_Insert, std::shared_ptr<Plan>(), x->tab_name, query->values,
                                                 std::vector<Condition>(), std::vector<SetClause>());
     }
     else if (auto x = std::dynamic_pointer_cast<ast::DeleteStmt>(query->parse))
@@ -556,16 +894,16 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
 
         if (index_meta.cols_.empty() )
         { // 该表没有索引
-            table_scan_executors = std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds,
+            table_scan_executors = arena_make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds,
                                                               index_meta);
         }
         else
         { // 存在索引
-            table_scan_executors = std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds,
+            table_scan_executors = arena_make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds,
                                                               index_meta);
         }
 
-        plannerRoot = std::make_shared<DMLPlan>(T_Delete, table_scan_executors, x->tab_name, std::vector<Value>(),
+        plannerRoot = arena_make_shared<DMLPlan>(T_Delete, table_scan_executors, x->tab_name, std::vector<Value>(),
                                                 query->conds, std::vector<SetClause>());
     }
     else if (auto x = std::dynamic_pointer_cast<ast::UpdateStmt>(query->parse))
@@ -579,22 +917,22 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
 
         if (index_meta.cols_.empty())
         { // 该表没有索引
-            table_scan_executors = std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds, index_meta);
+            table_scan_executors = arena_make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds, index_meta);
         }
         else
         { // 存在索引
-            table_scan_executors = std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_meta);
+            table_scan_executors = arena_make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_meta);
         }
-        plannerRoot = std::make_shared<DMLPlan>(T_Update, table_scan_executors, x->tab_name, std::vector<Value>(),
+        plannerRoot = arena_make_shared<DMLPlan>(T_Update, table_scan_executors, x->tab_name, std::vector<Value>(),
                                                 query->conds, query->set_clauses);
     }
     else if (auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse))
     {
         // select
-        std::shared_ptr<plannerInfo> root = std::make_shared<plannerInfo>(x);
+        std::shared_ptr<plannerInfo> root = arena_make_shared<plannerInfo>(x);
         // 生成select语句的查询执行计划
         std::shared_ptr<Plan> projection = generate_select_plan(std::move(query), context);
-        plannerRoot = std::make_shared<DMLPlan>(T_select, projection, std::string(), std::vector<Value>(),
+        plannerRoot = arena_make_shared<DMLPlan>(T_select, projection, std::string(), std::vector<Value>(),
                                                 std::vector<Condition>(), std::vector<SetClause>());
     }
     else
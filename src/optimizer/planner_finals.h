@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cassert>
+#include <cmath>
 #include <cstring>
 #include <memory>
 #include <string>
@@ -20,6 +21,7 @@ private:
 
     bool enable_nestedloop_join = true;
     bool enable_sortmerge_join = false;
+    bool enable_hashjoin = true;
 
 public:
     Planner(SmManager *sm_manager) : sm_manager_(sm_manager) {}
@@ -36,6 +38,11 @@ public:
         enable_sortmerge_join = set_val;
     }
 
+    void set_enable_hashjoin(bool set_val)
+    {
+        enable_hashjoin = set_val;
+    }
+
 private:
     std::shared_ptr<Query> logical_optimization(std::shared_ptr<Query> query, Context *context);
     std::shared_ptr<Plan> physical_optimization(const std::shared_ptr<Query> &query, Context *context);
@@ -44,9 +51,19 @@ private:
 
     std::shared_ptr<Plan> generate_sort_plan(const std::shared_ptr<Query> &query, std::shared_ptr<Plan> plan);
 
+    static std::shared_ptr<Plan> generate_limit_plan(const std::shared_ptr<Query> &query, std::shared_ptr<Plan> plan);
+
+    static size_t index_order_cols(const IndexMeta &index, const std::vector<Condition> &conds, const std::vector<TabCol> &sel_cols);
+
+    bool provide_order(const std::shared_ptr<Plan> &plan, const std::vector<TabCol> &sel_cols, bool is_desc);
+
     std::shared_ptr<Plan> generate_select_plan(std::shared_ptr<Query> query, Context *context);
 
-    static std::shared_ptr<Plan> generate_agg_plan(const std::shared_ptr<Query> &query, std::shared_ptr<Plan> plan);
+    std::shared_ptr<Plan> generate_agg_plan(const std::shared_ptr<Query> &query, std::shared_ptr<Plan> plan);
+
+    static size_t index_range_cols(const IndexMeta &index, const std::vector<Condition> &conds);
+
+    std::shared_ptr<Plan> generate_index_agg_plan(const std::shared_ptr<Plan> &plan, const std::vector<TabCol> &sel_cols);
 
     IndexMeta get_index_cols(const std::string &tab_name, const std::vector<Condition> &curr_conds);
 
@@ -58,4 +75,14 @@ private:
     std::shared_ptr<Plan> generate_join_sort_plan(const std::string &table, std::vector<Condition> &conds, TabCol &col, std::shared_ptr<Plan> plan);
 
     bool get_merge_join_index(const std::string &tab_name, const TabCol &col);
+
+    bool get_join_index(const std::string &tab_name, const TabCol &col, IndexMeta &index_meta);
+
+    double get_table_rows(const std::string &tab_name);
+
+    double estimate_rows(const std::shared_ptr<Plan> &plan);
+
+    double estimate_sort_merge_cost(const std::shared_ptr<Plan> &left, const std::shared_ptr<Plan> &right, const Condition &cond);
+
+    std::shared_ptr<Plan> make_join_plan(const std::shared_ptr<Plan> &left, const std::shared_ptr<Plan> &right, const Condition &cond, double &cost);
 };
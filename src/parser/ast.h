@@ -5,6 +5,7 @@
 #include <utility>
 #include <vector>
 
+#include "common/statement_arena_finals.h"
 #include "errors_finals.h"
 
 enum JoinType
@@ -48,7 +49,9 @@ namespace ast
     enum SetKnobType
     {
         EnableNestLoop,
-        EnableSortMerge
+        EnableSortMerge,
+        EnableHashJoin,
+        EnableResultStream
     };
 
     // Base class for tree nodes
@@ -190,6 +193,14 @@ namespace ast
         BoolLit(bool val_) : val(val_) {}
     };
 
+    // 预备语句中的占位符 $n，n 从 1 开始
+    struct ParamLit : public Value
+    {
+        int idx;
+
+        ParamLit(int idx_) : idx(idx_) {}
+    };
+
     struct Col : public Expr
     {
         std::string tab_name;
@@ -259,10 +270,34 @@ namespace ast
 
     struct OrderBy : public TreeNode
     {
-        std::shared_ptr<Col> cols;
-        OrderByDir orderby_dir;
+        std::vector<std::shared_ptr<Col>> cols;
+        std::vector<OrderByDir> orderby_dirs;
+
+        OrderBy(std::shared_ptr<Col> col, OrderByDir orderby_dir)
+        {
+            add(std::move(col), orderby_dir);
+        }
+
+        void add(std::shared_ptr<Col> col, OrderByDir orderby_dir)
+        {
+            cols.push_back(std::move(col));
+            orderby_dirs.push_back(orderby_dir);
+        }
+
+        // 只按一个字段升序排序
+        bool is_single_asc(const std::string &col_name) const
+        {
+            return cols.size() == 1 && orderby_dirs[0] != OrderBy_DESC && cols[0]->col_name == col_name;
+        }
+    };
+
+    // LIMIT limit OFFSET offset
+    struct Limit : public TreeNode
+    {
+        int limit;
+        int offset;
 
-        OrderBy(std::shared_ptr<Col> cols_, OrderByDir orderby_dir_) : cols(std::move(cols_)), orderby_dir(orderby_dir_) {}
+        Limit(int limit_, int offset_) : limit(limit_), offset(offset_) {}
     };
 
     struct CreateStaticCheckpoint : public TreeNode
@@ -346,7 +381,9 @@ namespace ast
         bool has_sort;
         std::shared_ptr<OrderBy> order;
 
-        SelectStmt(std::vector<std::shared_ptr<Col>> cols_, std::vector<std::string> tabs_, std::vector<std::shared_ptr<BinaryExpr>> conds_, std::shared_ptr<GroupBy> group_by_, std::shared_ptr<OrderBy> order_) : cols(std::move(cols_)), tabs(std::move(tabs_)), conds(std::move(conds_)), group_by(std::move(group_by_)), order(std::move(order_))
+        std::shared_ptr<Limit> limit;
+
+        SelectStmt(std::vector<std::shared_ptr<Col>> cols_, std::vector<std::string> tabs_, std::vector<std::shared_ptr<BinaryExpr>> conds_, std::shared_ptr<GroupBy> group_by_, std::shared_ptr<OrderBy> order_, std::shared_ptr<Limit> limit_ = nullptr) : cols(std::move(cols_)), tabs(std::move(tabs_)), conds(std::move(conds_)), group_by(std::move(group_by_)), order(std::move(order_)), limit(std::move(limit_))
         {
             has_sort = (bool)order;
             has_agg = false;
@@ -370,6 +407,29 @@ namespace ast
         LoadStmt(std::string file_name_, std::string table_name_) : file_name(std::move(file_name_)), tab_name(std::move(table_name_)) {}
     };
 
+    struct PrepareStmt : public TreeNode
+    {
+        std::string name;
+        std::shared_ptr<TreeNode> stmt;
+
+        PrepareStmt(std::string name_, std::shared_ptr<TreeNode> stmt_) : name(std::move(name_)), stmt(std::move(stmt_)) {}
+    };
+
+    struct ExecuteStmt : public TreeNode
+    {
+        std::string name;
+        std::vector<std::shared_ptr<Value>> vals;
+
+        ExecuteStmt(std::string name_, std::vector<std::shared_ptr<Value>> vals_) : name(std::move(name_)), vals(std::move(vals_)) {}
+    };
+
+    struct DeallocateStmt : public TreeNode
+    {
+        std::string name;
+
+        DeallocateStmt(std::string name_) : name(std::move(name_)) {}
+    };
+
     // Semantic value
     struct SemValue
     {
@@ -410,11 +470,11 @@ namespace ast
 
         std::shared_ptr<OrderBy> sv_orderby;
 
+        std::shared_ptr<Limit> sv_limit;
+
         SetKnobType sv_setKnobType;
     };
 
-    extern std::shared_ptr<ast::TreeNode> parse_tree;
-
 } // namespace ast
 
 #define YYSTYPE ast::SemValue
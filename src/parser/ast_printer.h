@@ -144,6 +144,11 @@ namespace ast
                 std::cout << "STRING_LIT\n";
                 print_val(x->val, offset);
             }
+            else if (auto x = std::dynamic_pointer_cast<ParamLit>(node))
+            {
+                std::cout << "PARAM\n";
+                print_val(x->idx, offset);
+            }
             else if (auto x = std::dynamic_pointer_cast<SetClause>(node))
             {
                 std::cout << "SET_CLAUSE\n";
@@ -214,6 +219,23 @@ namespace ast
             {
                 std::cout << "CRASH\n";
             }
+            else if (auto x = std::dynamic_pointer_cast<PrepareStmt>(node))
+            {
+                std::cout << "PREPARE\n";
+                print_val(x->name, offset);
+                print_node(x->stmt, offset);
+            }
+            else if (auto x = std::dynamic_pointer_cast<ExecuteStmt>(node))
+            {
+                std::cout << "EXECUTE\n";
+                print_val(x->name, offset);
+                print_node_list(x->vals, offset);
+            }
+            else if (auto x = std::dynamic_pointer_cast<DeallocateStmt>(node))
+            {
+                std::cout << "DEALLOCATE\n";
+                print_val(x->name, offset);
+            }
             else
             {
                 assert(0);
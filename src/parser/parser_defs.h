@@ -1,11 +1,45 @@
 #pragma once
 
+#include <memory>
+
+#include "ast.h"
 #include "defs_finals.h"
 
-int yyparse();
+typedef void *yyscan_t;
+
+int yylex_init(yyscan_t *scanner);
+
+int yylex_destroy(yyscan_t scanner);
+
+int yyparse(yyscan_t scanner, std::shared_ptr<ast::TreeNode> &parse_tree);
 
 typedef struct yy_buffer_state *YY_BUFFER_STATE;
 
-YY_BUFFER_STATE yy_scan_string(const char *str);
+YY_BUFFER_STATE yy_scan_string(const char *str, yyscan_t scanner);
+
+void yy_delete_buffer(YY_BUFFER_STATE buffer, yyscan_t scanner);
+
+// 可重入的 SQL 解析器：扫描器状态保存在对象中，每个连接持有一个，不同连接可以同时解析
+class SqlParser
+{
+public:
+    SqlParser() { yylex_init(&scanner_); }
+
+    SqlParser(const SqlParser &) = delete;
+
+    SqlParser &operator=(const SqlParser &) = delete;
+
+    ~SqlParser() { yylex_destroy(scanner_); }
+
+    // 解析一条语句，语法错误时返回 false；EXIT 或空输入时 parse_tree 为空
+    bool parse(const char *sql, std::shared_ptr<ast::TreeNode> &parse_tree)
+    {
+        YY_BUFFER_STATE buf = yy_scan_string(sql, scanner_);
+        bool ok = yyparse(scanner_, parse_tree) == 0;
+        yy_delete_buffer(buf, scanner_);
+        return ok;
+    }
 
-void yy_delete_buffer(YY_BUFFER_STATE buffer);
+private:
+    yyscan_t scanner_;
+};
@@ -1,22 +1,22 @@
-
 #undef NDEBUG
 
 #include <cassert>
+#include <thread>
 
 #include "parser.h"
 
 int main()
 {
-    std::vector<std::string> sqls = {"update t1 set id=id-1;"};
+    std::vector<std::string> sqls = {"update t1 set id=id-1;", "prepare q as select * from t1 where id = $1;", "execute q(1);", "deallocate q;"};
+    SqlParser parser;
     for (auto &sql : sqls)
     {
         std::cout << sql << std::endl;
-        YY_BUFFER_STATE buf = yy_scan_string(sql.c_str());
-        assert(yyparse() == 0);
-        if (ast::parse_tree != nullptr)
+        std::shared_ptr<ast::TreeNode> parse_tree;
+        assert(parser.parse(sql.c_str(), parse_tree));
+        if (parse_tree != nullptr)
         {
-            ast::TreePrinter::print(ast::parse_tree);
-            yy_delete_buffer(buf);
+            ast::TreePrinter::print(parse_tree);
             std::cout << std::endl;
         }
         else
@@ -24,6 +24,29 @@ int main()
             std::cout << "exit/EOF" << std::endl;
         }
     }
-    ast::parse_tree.reset();
+
+    // 每个线程使用自己的解析器，同时解析不会互相影响
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([i]
+                             {
+            SqlParser thread_parser;
+            std::string tab = "t" + std::to_string(i);
+            std::shared_ptr<ast::TreeNode> error_tree;
+            assert(!thread_parser.parse("select from;", error_tree));
+            for (int j = 0; j < 1000; j++)
+            {
+                std::shared_ptr<ast::TreeNode> parse_tree;
+                std::string sql = "select * from " + tab + " where id = " + std::to_string(j) + ";";
+                assert(thread_parser.parse(sql.c_str(), parse_tree));
+                auto select = std::dynamic_pointer_cast<ast::SelectStmt>(parse_tree);
+                assert(select != nullptr && select->tabs.size() == 1 && select->tabs[0] == tab);
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
     return 0;
 }
@@ -4,9 +4,9 @@
 #include <iostream>
 #include <memory>
 
-int yylex(YYSTYPE *yylval, YYLTYPE *yylloc);
+int yylex(YYSTYPE *yylval, YYLTYPE *yylloc, void *scanner);
 
-void yyerror(YYLTYPE *locp, const char* s) {
+void yyerror(YYLTYPE *locp, void *scanner, std::shared_ptr<ast::TreeNode> &parse_tree, const char* s) {
     std::cerr << "Parser Error at line " << locp->first_line << " column " << locp->first_column << ": " << s << std::endl;
 }
 
@@ -15,6 +15,9 @@ using namespace ast;
 
 // request a pure (reentrant) parser
 %define api.pure full
+// scanner state and parse result are passed in by the caller instead of globals
+%param {void *scanner}
+%parse-param {std::shared_ptr<ast::TreeNode> &parse_tree}
 // enable location in error handler
 %locations
 // enable verbose syntax error message
@@ -22,20 +25,20 @@ using namespace ast;
 
 // keywords
 %token SHOW TABLES CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM ASC ORDER BY
-WHERE UPDATE SET SELECT INT CHAR FLOAT DATETIME INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY ENABLE_NESTLOOP ENABLE_SORTMERGE STATIC_CHECKPOINT CRASH
-MAX MIN AVG COUNT SUM GROUP HAVING AS IN NOT LOAD SIGN_ADD SIGN_SUB
+WHERE UPDATE SET SELECT INT CHAR FLOAT DATETIME INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY ENABLE_NESTLOOP ENABLE_SORTMERGE ENABLE_HASHJOIN ENABLE_RESULT_STREAM STATIC_CHECKPOINT CRASH LIMIT OFFSET
+MAX MIN AVG COUNT SUM GROUP HAVING AS IN NOT LOAD SIGN_ADD SIGN_SUB PREPARE EXECUTE DEALLOCATE
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
 %token OUTPUT_FILE ON OFF
 
 // type-specific tokens
 %token <sv_str> IDENTIFIER VALUE_STRING VALUE_PATH
-%token <sv_int> VALUE_INT
+%token <sv_int> VALUE_INT VALUE_PARAM
 %token <sv_float> VALUE_FLOAT
 %token <sv_bool> VALUE_BOOL
 
 // specify types for non-terminal symbol
-%type <sv_node> stmt dbStmt ddl dml txnStmt setStmt crashStmt io_stmt
+%type <sv_node> stmt dbStmt ddl dml txnStmt setStmt crashStmt io_stmt prepareStmt
 %type <sv_field> field
 %type <sv_fields> fieldList
 %type <sv_type_len> type
@@ -57,6 +60,7 @@ MAX MIN AVG COUNT SUM GROUP HAVING AS IN NOT LOAD SIGN_ADD SIGN_SUB
 %type <sv_group_by> optGroupByClause groupByClause
 %type <sv_orderby>  order_clause opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
+%type <sv_limit> opt_limit_clause
 %type <sv_setKnobType> set_knob_type
 
 %%
@@ -68,7 +72,7 @@ start:
     }
     |   HELP
     {
-        parse_tree = std::make_shared<Help>();
+        parse_tree = arena_make_shared<Help>();
         YYACCEPT;
     }
     |   EXIT
@@ -95,109 +99,129 @@ stmt:
     |   txnStmt
     |   setStmt
     |   crashStmt
+    |   prepareStmt
     ;
 
 crashStmt:
         CRASH
     {
-        $$ = std::make_shared<CrashStmt>();
+        $$ = arena_make_shared<CrashStmt>();
+    }
+    ;
+
+prepareStmt:
+        PREPARE IDENTIFIER AS dml
+    {
+        $$ = arena_make_shared<PrepareStmt>($2, $4);
+    }
+    |   EXECUTE IDENTIFIER
+    {
+        $$ = arena_make_shared<ExecuteStmt>($2, std::vector<std::shared_ptr<Value>>());
+    }
+    |   EXECUTE IDENTIFIER '(' valueList ')'
+    {
+        $$ = arena_make_shared<ExecuteStmt>($2, $4);
+    }
+    |   DEALLOCATE IDENTIFIER
+    {
+        $$ = arena_make_shared<DeallocateStmt>($2);
     }
     ;
 
 txnStmt:
         TXN_BEGIN
     {
-        $$ = std::make_shared<TxnBegin>();
+        $$ = arena_make_shared<TxnBegin>();
     }
     |   TXN_COMMIT
     {
-        $$ = std::make_shared<TxnCommit>();
+        $$ = arena_make_shared<TxnCommit>();
     }
     |   TXN_ABORT
     {
-        $$ = std::make_shared<TxnAbort>();
+        $$ = arena_make_shared<TxnAbort>();
     }
     | TXN_ROLLBACK
     {
-        $$ = std::make_shared<TxnRollback>();
+        $$ = arena_make_shared<TxnRollback>();
     }
     ;
 
 dbStmt:
         SHOW TABLES
     {
-        $$ = std::make_shared<ShowTables>();
+        $$ = arena_make_shared<ShowTables>();
     }
     |   LOAD fileName INTO tbName
     {
-         $$ = std::make_shared<LoadStmt>($2, $4);
+         $$ = arena_make_shared<LoadStmt>($2, $4);
     }
     ;
 
 setStmt:
         SET set_knob_type '=' VALUE_BOOL
     {
-        $$ = std::make_shared<SetStmt>($2, $4);
+        $$ = arena_make_shared<SetStmt>($2, $4);
     }
     ;
 io_stmt:
         SET OUTPUT_FILE ON
     {
-        $$ = std::make_shared<IoEnable>(true);
+        $$ = arena_make_shared<IoEnable>(true);
     }
     |   SET OUTPUT_FILE OFF
     {
-        $$ = std::make_shared<IoEnable>(false);
+        $$ = arena_make_shared<IoEnable>(false);
     }
     ;
 ddl:
         CREATE TABLE tbName '(' fieldList ')'
     {
-        $$ = std::make_shared<CreateTable>($3, $5);
+        $$ = arena_make_shared<CreateTable>($3, $5);
     }
     |   DROP TABLE tbName
     {
-        $$ = std::make_shared<DropTable>($3);
+        $$ = arena_make_shared<DropTable>($3);
     }
     |   DESC tbName
     {
-        $$ = std::make_shared<DescTable>($2);
+        $$ = arena_make_shared<DescTable>($2);
     }
     |   CREATE INDEX tbName '(' colNameList ')'
     {
-        $$ = std::make_shared<CreateIndex>($3, $5);
+        $$ = arena_make_shared<CreateIndex>($3, $5);
     }
     |   DROP INDEX tbName '(' colNameList ')'
     {
-        $$ = std::make_shared<DropIndex>($3, $5);
+        $$ = arena_make_shared<DropIndex>($3, $5);
     }
     |  SHOW INDEX FROM tbName
     {
-    	$$ = std::make_shared<DescIndex>($4);
+    	$$ = arena_make_shared<DescIndex>($4);
     }
     ;
     |   CREATE STATIC_CHECKPOINT
     {
-        $$ = std::make_shared<CreateStaticCheckpoint>();
+        $$ = arena_make_shared<CreateStaticCheckpoint>();
     }
     ;
 
 dml:
         INSERT INTO tbName VALUES '(' valueList ')'
     {
-        $$ = std::make_shared<InsertStmt>($3, $6);
+        $$ = arena_make_shared<InsertStmt>($3, $6);
     }
     |   DELETE FROM tbName optWhereClause
     {
-        $$ = std::make_shared<DeleteStmt>($3, $4);
+        $$ = arena_make_shared<DeleteStmt>($3, $4);
     }
     |   UPDATE tbName SET setClauses optWhereClause
     {
-        $$ = std::make_shared<UpdateStmt>($2, $4, $5);
+        $$ = arena_make_shared<UpdateStmt>($2, $4, $5);
     }
-    |   SELECT selector FROM tableList optWhereClause optGroupByClause opt_order_clause
+    |   SELECT selector FROM tableList optWhereClause optGroupByClause opt_order_clause opt_limit_clause
     {
-	$$ = std::make_shared<SelectStmt>($2, $4, $5, $6, $7);
+	$$ = arena_make_shared<SelectStmt>($2, $4, $5, $6, $7, $8);
     }
     ;
 
@@ -226,26 +250,26 @@ colNameList:
 field:
         colName type
     {
-        $$ = std::make_shared<ColDef>($1, $2);
+        $$ = arena_make_shared<ColDef>($1, $2);
     }
     ;
 
 type:
         INT
     {
-        $$ = std::make_shared<TypeLen>(SV_TYPE_INT, sizeof(int));
+        $$ = arena_make_shared<TypeLen>(SV_TYPE_INT, sizeof(int));
     }
     |   CHAR '(' VALUE_INT ')'
     {
-        $$ = std::make_shared<TypeLen>(SV_TYPE_STRING, $3);
+        $$ = arena_make_shared<TypeLen>(SV_TYPE_STRING, $3);
     }
     |   FLOAT
     {
-        $$ = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
+        $$ = arena_make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
     }
     |   DATETIME
     {
-        $$ = std::make_shared<TypeLen>(SV_TYPE_DATETIME, 19);
+        $$ = arena_make_shared<TypeLen>(SV_TYPE_DATETIME, 19);
     }
     ;
 
@@ -263,41 +287,45 @@ valueList:
 value:
         VALUE_INT
     {
-        $$ = std::make_shared<IntLit>($1);
+        $$ = arena_make_shared<IntLit>($1);
     }
     |   VALUE_FLOAT
     {
-        $$ = std::make_shared<FloatLit>($1);
+        $$ = arena_make_shared<FloatLit>($1);
     }
     |   VALUE_STRING
     {
-        $$ = std::make_shared<StringLit>($1);
+        $$ = arena_make_shared<StringLit>($1);
     }
     |   VALUE_BOOL
     {
-        $$ = std::make_shared<BoolLit>($1);
+        $$ = arena_make_shared<BoolLit>($1);
+    }
+    |   VALUE_PARAM
+    {
+        $$ = arena_make_shared<ParamLit>($1);
     }
     ;
 
 condition:
         col op expr
     {
-        $$ = std::make_shared<BinaryExpr>($1, $2, $3);
+        $$ = arena_make_shared<BinaryExpr>($1, $2, $3);
     }
     |   col op '(' dml ')'
     {
-	$$ = std::make_shared<SubQueryExpr>($1, $2, $4);
+	$$ = arena_make_shared<SubQueryExpr>($1, $2, $4);
     }
     |   col op '(' valueList ')'
     {
-	$$ = std::make_shared<SubQueryExpr>($1, $2, $4);
+	$$ = arena_make_shared<SubQueryExpr>($1, $2, $4);
     }
     ;
 
 havingCondition:
     aggFunc op expr
     {
-	$$ = std::make_shared<HavingCause>($1 ,$2, $3);
+	$$ = arena_make_shared<HavingCause>($1 ,$2, $3);
     }
     ;
 
@@ -323,11 +351,11 @@ whereClause:
 col:
         tbName '.' colName
     {
-        $$ = std::make_shared<Col>($1, $3);
+        $$ = arena_make_shared<Col>($1, $3);
     }
     |   colName
     {
-        $$ = std::make_shared<Col>("", $1);
+        $$ = arena_make_shared<Col>("", $1);
     }
     |   aggFunc
     {
@@ -335,7 +363,7 @@ col:
     }
     |   colName AS ALIAS
     {
-	$$ = std::make_shared<Col>("", $1, $3);
+	$$ = arena_make_shared<Col>("", $1, $3);
 	$$->alias = $3;
     }
     |   aggFunc AS ALIAS
@@ -347,23 +375,23 @@ col:
 aggFunc:
         SUM '(' col ')'
     {
-        $$ = std::make_shared<AggFunc>($3->tab_name, $3->col_name, AggFuncType::SUM);
+        $$ = arena_make_shared<AggFunc>($3->tab_name, $3->col_name, AggFuncType::SUM);
     }
     |   MIN '(' col ')'
     {
-        $$ = std::make_shared<AggFunc>($3->tab_name, $3->col_name, AggFuncType::MIN);
+        $$ = arena_make_shared<AggFunc>($3->tab_name, $3->col_name, AggFuncType::MIN);
     }
     |   MAX '(' col ')'
     {
-        $$ = std::make_shared<AggFunc>($3->tab_name, $3->col_name, AggFuncType::MAX);
+        $$ = arena_make_shared<AggFunc>($3->tab_name, $3->col_name, AggFuncType::MAX);
     }
     |   COUNT '(' col ')'
     {
-        $$ = std::make_shared<AggFunc>($3->tab_name, $3->col_name, AggFuncType::COUNT);
+        $$ = arena_make_shared<AggFunc>($3->tab_name, $3->col_name, AggFuncType::COUNT);
     }
     |   COUNT '(' '*' ')'
     {
-        $$ = std::make_shared<AggFunc>("", "*", AggFuncType::COUNT);
+        $$ = arena_make_shared<AggFunc>("", "*", AggFuncType::COUNT);
     }
     ;
 
@@ -393,7 +421,7 @@ optGroupByClause:
 groupByClause:
     GROUP BY colList
     {
-        $$ = std::make_shared<GroupBy>($3);
+        $$ = arena_make_shared<GroupBy>($3);
     }
     ;
 optHavingClause:
@@ -478,27 +506,27 @@ setClauses:
 setClause:
         colName '=' value
     {
-        $$ = std::make_shared<SetClause>($1, $3);
+        $$ = arena_make_shared<SetClause>($1, $3);
     }
     |   colName '=' colName  value
     {
-        $$ = std::make_shared<SetClause>($1, $4, 4);
+        $$ = arena_make_shared<SetClause>($1, $4, 4);
     }
     |   colName '=' colName SIGN_ADD value
     {
-        $$ = std::make_shared<SetClause>($1, $5, 0);
+        $$ = arena_make_shared<SetClause>($1, $5, 0);
     }
     |   colName '=' colName SIGN_SUB value
     {
-        $$ = std::make_shared<SetClause>($1, $5, 1);
+        $$ = arena_make_shared<SetClause>($1, $5, 1);
     }
     |   colName '=' colName '*' value
     {
-        $$ = std::make_shared<SetClause>($1, $5, 2);
+        $$ = arena_make_shared<SetClause>($1, $5, 2);
     }
     |   colName '=' colName '/' value
     {
-        $$ = std::make_shared<SetClause>($1, $5, 3);
+        $$ = arena_make_shared<SetClause>($1, $5, 3);
     }
     ;
 
@@ -536,7 +564,12 @@ opt_order_clause:
 order_clause:
       col  opt_asc_desc 
     { 
-        $$ = std::make_shared<OrderBy>($1, $2);
+        $$ = arena_make_shared<OrderBy>($1, $2);
+    }
+    |   order_clause ',' col opt_asc_desc
+    {
+        $$ = $1;
+        $$->add($3, $4);
     }
     ;   
 
@@ -546,9 +579,23 @@ opt_asc_desc:
     |       { $$ = OrderBy_DEFAULT; }
     ;    
 
+opt_limit_clause:
+    LIMIT VALUE_INT
+    {
+        $$ = arena_make_shared<Limit>($2, 0);
+    }
+    |   LIMIT VALUE_INT OFFSET VALUE_INT
+    {
+        $$ = arena_make_shared<Limit>($2, $4);
+    }
+    |   /* epsilon */ { /* ignore*/ }
+    ;
+
 set_knob_type:
     ENABLE_NESTLOOP { $$ = EnableNestLoop; }
     |   ENABLE_SORTMERGE { $$ = EnableSortMerge; }
+    |   ENABLE_HASHJOIN { $$ = EnableHashJoin; }
+    |   ENABLE_RESULT_STREAM { $$ = EnableResultStream; }
     ;
 
 tbName: IDENTIFIER;
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "analyze/analyze_finals.h"
+#include "optimizer/optimizer_finals.h"
+
+// 预备语句：PREPARE name AS dml 时分析并生成带占位符（$1, $2, ...）的执行计划，按名字缓存在连接中；
+// EXECUTE name(args) 只把参数写入计划中的 Condition::rhs_val、SetClause::rhs 和插入的值，不再解析、分析和优化。
+// 建表、删表、建索引、删索引会改变 DbMeta::version_，元数据在计划生成后变化过时，EXECUTE 先重新分析原语句
+class PlanCache
+{
+public:
+    PlanCache(SmManager *sm_manager, Analyze *analyze, Optimizer *optimizer) : sm_manager_(sm_manager), analyze_(analyze), optimizer_(optimizer) {}
+
+    // 同名的预备语句会被替换
+    void prepare(const std::string &name, const std::shared_ptr<ast::TreeNode> &stmt, Context *context)
+    {
+        Entry entry{.stmt = stmt};
+        plan(entry, context);
+        entries_[name] = std::move(entry);
+    }
+
+    // 绑定参数，返回可以交给 Portal::start 的计划；名字不存在、参数个数或类型不符时报错
+    std::shared_ptr<Plan> bind(const std::string &name, const std::vector<std::shared_ptr<ast::Value>> &sv_args, Context *context)
+    {
+        auto it = entries_.find(name);
+        if (it == entries_.end())
+        {
+            throw RMDBError();
+        }
+        auto &entry = it->second;
+        if (entry.version != sm_manager_->db_.version_)
+        {
+            plan(entry, context);
+        }
+
+        std::vector<Value> args;
+        for (auto &sv_arg : sv_args)
+        {
+            args.push_back(Analyze::convert_sv_value(sv_arg));
+        }
+        if (args.size() != entry.param_num)
+        {
+            throw RMDBError();
+        }
+        bind_plan(entry.plan, args);
+        return entry.plan;
+    }
+
+    void deallocate(const std::string &name)
+    {
+        if (entries_.erase(name) == 0)
+        {
+            throw RMDBError();
+        }
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<ast::TreeNode> stmt;
+        std::shared_ptr<Plan> plan;
+        size_t param_num = 0;
+        uint64_t version = 0;
+    };
+
+    // 分析并生成计划，计划要跨语句保留，不使用语句的内存池
+    void plan(Entry &entry, Context *context)
+    {
+        StatementArena::Scope heap_scope(nullptr);
+        // 先取版本号：分析期间发生的 DDL 会让下一次 EXECUTE 重新生成计划
+        uint64_t version = sm_manager_->db_.version_;
+        auto query = analyze_->do_analyze(entry.stmt);
+        entry.plan = optimizer_->plan_query(query, context);
+        entry.param_num = query->param_num;
+        entry.version = version;
+    }
+
+    static void bind_plan(const std::shared_ptr<Plan> &plan, const std::vector<Value> &args)
+    {
+        if (plan == nullptr)
+        {
+            return;
+        }
+        if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan))
+        {
+            bind_conds(x->conds_, args);
+        }
+        else if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan))
+        {
+            bind_plan(x->left_, args);
+            bind_plan(x->right_, args);
+            bind_conds(x->conds_, args);
+        }
+        else if (auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan))
+        {
+            bind_plan(x->subplan_, args);
+        }
+        else if (auto x = std::dynamic_pointer_cast<SortPlan>(plan))
+        {
+            bind_plan(x->subplan_, args);
+        }
+        else if (auto x = std::dynamic_pointer_cast<LimitPlan>(plan))
+        {
+            bind_plan(x->subplan_, args);
+        }
+        else if (auto x = std::dynamic_pointer_cast<AggPlan>(plan))
+        {
+            bind_plan(x->subplan_, args);
+        }
+        else if (auto x = std::dynamic_pointer_cast<HavingPlan>(plan))
+        {
+            bind_plan(x->subplan_, args);
+        }
+        else if (auto x = std::dynamic_pointer_cast<IndexAggPlan>(plan))
+        {
+            bind_conds(x->conds_, args);
+        }
+        else if (auto x = std::dynamic_pointer_cast<DMLPlan>(plan))
+        {
+            bind_plan(x->subplan_, args);
+            bind_conds(x->conds_, args);
+            for (auto &set_clause : x->set_clauses_)
+            {
+                if (bind_value(set_clause.rhs, args))
+                {
+                    Analyze::convert_set_value(set_clause);
+                }
+            }
+            // 插入的值由 InsertExecutor 按列类型转换
+            for (auto &val : x->values_)
+            {
+                bind_value(val, args);
+            }
+        }
+    }
+
+    static void bind_conds(std::vector<Condition> &conds, const std::vector<Value> &args)
+    {
+        for (auto &cond : conds)
+        {
+            if (cond.is_rhs_val && bind_value(cond.rhs_val, args))
+            {
+                Analyze::convert_cond_value(cond);
+            }
+        }
+    }
+
+    // 占位符换成对应的参数，保留编号以便下一次绑定；常量不变，返回 false
+    static bool bind_value(Value &val, const std::vector<Value> &args)
+    {
+        if (val.param < 0)
+        {
+            return false;
+        }
+        int param = val.param;
+        val = args[param];
+        val.param = param;
+        return true;
+    }
+
+    SmManager *sm_manager_;
+    Analyze *analyze_;
+    Optimizer *optimizer_;
+    std::unordered_map<std::string, Entry> entries_;
+};
@@ -10,11 +10,16 @@
 #include "execution/execution_sort_finals.h"
 #include "execution/executor_abstract_finals.h"
 #include "execution/executor_delete_finals.h"
+#include "execution/executor_hash_join_finals.h"
+#include "execution/executor_index_agg_finals.h"
+#include "execution/executor_index_nestedloop_join_finals.h"
 #include "execution/executor_index_scan_finals.h"
 #include "execution/executor_insert_finals.h"
+#include "execution/executor_limit_finals.h"
 #include "execution/executor_nestedloop_join_finals.h"
 #include "execution/executor_projection_finals.h"
 #include "execution/executor_seq_scan_finals.h"
+#include "execution/executor_top_n_finals.h"
 #include "execution/executor_update_finals.h"
 #include "optimizer/plan_finals.h"
 
@@ -74,7 +79,7 @@ public:
             {
                 std::shared_ptr<ProjectionPlan> p = std::dynamic_pointer_cast<ProjectionPlan>(x->subplan_);
                 std::unique_ptr<AbstractExecutor> root = convert_plan_executor(p, context);
-                return std::make_shared<PortalStmt>(PORTAL_ONE_SELECT, std::move(p->sel_cols_), std::move(root), plan);
+                return std::make_shared<PortalStmt>(PORTAL_ONE_SELECT, p->sel_cols_, std::move(root), plan);
             }
 
             case T_Update:
@@ -181,32 +186,57 @@ public:
 
             if (x->tag == T_SeqScan)
             {
-                return std::make_unique<SeqScanExecutor>(sm_manager_, x->tab_name_, x->conds_, context);
+                auto scan = std::make_unique<SeqScanExecutor>(sm_manager_, x->tab_name_, x->conds_, context);
+                if (x->limit_ >= 0)
+                {
+                    scan->set_row_limit(x->limit_);
+                }
+                return scan;
             }
             else
             {
-                return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_meta_, context);
+                return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_meta_, context, x->reverse_, x->order_cols_);
             }
         }
         else if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan))
         {
+            if (x->tag == T_IndexNestLoop)
+            {
+                // 内表不单独生成扫描算子，由 join 算子按连接键查索引
+                auto inner = std::dynamic_pointer_cast<ScanPlan>(x->right_);
+                return std::make_unique<IndexNestedLoopJoinExecutor>(convert_plan_executor(x->left_, context), sm_manager_, inner->tab_name_, inner->conds_, inner->index_meta_, x->conds_, context);
+            }
             std::unique_ptr<AbstractExecutor> left = convert_plan_executor(x->left_, context);
             std::unique_ptr<AbstractExecutor> right = convert_plan_executor(x->right_, context);
             std::unique_ptr<AbstractExecutor> join;
             if (x->tag == T_NestLoop)
-                join = std::make_unique<NestedLoopJoinExecutor>(std::move(left), std::move(right), std::move(x->conds_));
+                join = std::make_unique<NestedLoopJoinExecutor>(std::move(left), std::move(right), x->conds_, context);
+            else if (x->tag == T_HashJoin)
+                join = std::make_unique<HashJoinExecutor>(std::move(left), std::move(right), x->conds_, context);
             else
-                join = std::make_unique<MergeJoinExecutor>(std::move(left), std::move(right), std::move(x->conds_), x->left_join_col, x->right_join_col, x->tables);
+                join = std::make_unique<MergeJoinExecutor>(std::move(left), std::move(right), x->conds_, x->left_join_col, x->right_join_col, x->tables);
             return join;
         }
         else if (auto x = std::dynamic_pointer_cast<SortPlan>(plan))
         {
-            return std::make_unique<SortExecutor>(convert_plan_executor(x->subplan_, context), x->sel_col_);
+            if (x->limit_ >= 0)
+            {
+                return std::make_unique<TopNExecutor>(convert_plan_executor(x->subplan_, context), x->sel_cols_, x->is_descs_, x->limit_);
+            }
+            return std::make_unique<SortExecutor>(convert_plan_executor(x->subplan_, context), x->sel_cols_, x->is_descs_, context);
+        }
+        else if (auto x = std::dynamic_pointer_cast<LimitPlan>(plan))
+        {
+            return std::make_unique<LimitExecutor>(convert_plan_executor(x->subplan_, context), x->limit_, x->offset_);
         }
         else if (auto x = std::dynamic_pointer_cast<AggPlan>(plan))
         {
             return std::make_unique<AggPlanExecutor>(convert_plan_executor(x->subplan_, context), x->group_by_cols, x->sel_cols_, context);
         }
+        else if (auto x = std::dynamic_pointer_cast<IndexAggPlan>(plan))
+        {
+            return std::make_unique<IndexAggExecutor>(sm_manager_, x->tab_name_, x->conds_, x->agg_cols_, context);
+        }
         else if (auto x = std::dynamic_pointer_cast<HavingPlan>(plan))
         {
             return std::make_unique<HavingPlanExecutor>(convert_plan_executor(x->subplan_, context), x->sel_cols_, x->having_conds_, context);
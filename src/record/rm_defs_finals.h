@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+
 struct RmRecord
 {
     char *data = nullptr; // 记录的数据
@@ -15,4 +17,12 @@ struct RmRecord
         size = size_;
         data = new char[size_];
     }
+
+    // 拷贝 data_ 中的记录到新分配的内存
+    static RmRecord copy_of(const char *data_, int size_)
+    {
+        RmRecord record(size_);
+        memcpy(record.data, data_, size_);
+        return record;
+    }
 };
@@ -7,6 +7,7 @@
 
 #include "common/context_finals.h"
 #include "rm_defs_finals.h"
+#include "rm_zone_map_finals.h"
 
 class RmFileHandle
 {
@@ -15,7 +16,7 @@ public:
     bool ban = false;
     std::vector<char *> records;
 
-    explicit RmFileHandle(int record_size) : record_size(record_size) {}
+    RmFileHandle(int record_size, std::vector<ColMeta> cols) : record_size(record_size), zone_map_(std::move(cols), record_size) {}
 
     std::unique_ptr<RmRecord> get_record(char *rid)
     {
@@ -29,6 +30,7 @@ public:
             return;
         }
         records.emplace_back(rid);
+        zone_map_.append(records.size() - 1, rid);
     }
 
     void delete_record(char *rid)
@@ -37,7 +39,13 @@ public:
         {
             return;
         }
-        records.erase(std::remove(records.begin(), records.end(), rid), records.end());
+        auto it = std::find(records.begin(), records.end(), rid);
+        if (it == records.end())
+        {
+            return;
+        }
+        zone_map_.erase(it - records.begin());
+        records.erase(std::remove(it, records.end(), rid), records.end());
     }
 
     void update_record(const char *old_rid_, char *new_rid_)
@@ -51,8 +59,19 @@ public:
             if (rid_ == old_rid_)
             {
                 rid_ = new_rid_;
+                zone_map_.update(&rid_ - records.data(), new_rid_);
                 return;
             }
         }
     }
+
+    // 扫描前取得区域映射，每一块的范围都是有效的
+    const ZoneMap &zone_map()
+    {
+        zone_map_.refresh(records);
+        return zone_map_;
+    }
+
+private:
+    ZoneMap zone_map_;
 };
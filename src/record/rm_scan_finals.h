@@ -31,3 +31,28 @@ public:
         return *it;
     }
 };
+
+// 扫描一组预先选出的记录（例如并行过滤的结果）
+class RidListScan : public RecScan
+{
+    std::vector<char *> rids_;
+    size_t pos_ = 0;
+
+public:
+    explicit RidListScan(std::vector<char *> rids) : rids_(std::move(rids)) {}
+
+    void next() override
+    {
+        pos_++;
+    }
+
+    bool is_end() const override
+    {
+        return pos_ == rids_.size();
+    }
+
+    char *rid() const override
+    {
+        return rids_[pos_];
+    }
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "common/config_finals.h"
+#include "common/value_finals.h"
+
+// 区域映射：记录数组每 ZONE_MAP_ROWS 条为一块，保存块内各字段的最小值和最大值
+// 最小值、最大值按记录格式存放（第 i 个字段在 offset_i 处），可以直接与 Gap 的上下界比较
+// 插入和更新只会放宽所在块的范围；删除会让之后的记录前移，从删除位置所在的块起标记为失效，扫描前再重新计算
+class ZoneMap
+{
+public:
+    ZoneMap(std::vector<ColMeta> cols, int record_size) : cols_(std::move(cols)), record_size_(record_size) {}
+
+    size_t block_num() const { return valid_blocks_; }
+
+    const char *min(size_t block) const { return mins_.data() + block * record_size_; }
+
+    const char *max(size_t block) const { return maxs_.data() + block * record_size_; }
+
+    // 第 pos 条记录追加到记录数组末尾
+    void append(size_t pos, const char *row)
+    {
+        size_t block = pos / ZONE_MAP_ROWS;
+        if (block < valid_blocks_)
+        {
+            widen(block, row);
+        }
+        else if (block == valid_blocks_ && pos % ZONE_MAP_ROWS == 0)
+        {
+            init_block(block, row);
+            valid_blocks_++;
+        }
+    }
+
+    // 第 pos 条记录被替换为 row
+    void update(size_t pos, const char *row)
+    {
+        size_t block = pos / ZONE_MAP_ROWS;
+        if (block < valid_blocks_)
+        {
+            widen(block, row);
+        }
+    }
+
+    // 第 pos 条记录被删除，之后的记录前移
+    void erase(size_t pos) { valid_blocks_ = std::min(valid_blocks_, pos / ZONE_MAP_ROWS); }
+
+    // 重新计算失效的块，使每一块都有范围；多个扫描可能同时调用
+    void refresh(const std::vector<char *> &records)
+    {
+        std::lock_guard lock(latch_);
+        size_t block_num = (records.size() + ZONE_MAP_ROWS - 1) / ZONE_MAP_ROWS;
+        for (size_t block = valid_blocks_; block < block_num; block++)
+        {
+            size_t begin = block * ZONE_MAP_ROWS;
+            size_t end = std::min(records.size(), begin + ZONE_MAP_ROWS);
+            init_block(block, records[begin]);
+            for (size_t pos = begin + 1; pos < end; pos++)
+            {
+                widen(block, records[pos]);
+            }
+        }
+        valid_blocks_ = block_num;
+    }
+
+private:
+    void init_block(size_t block, const char *row)
+    {
+        if (mins_.size() < (block + 1) * record_size_)
+        {
+            mins_.resize((block + 1) * record_size_);
+            maxs_.resize((block + 1) * record_size_);
+        }
+        memcpy(mins_.data() + block * record_size_, row, record_size_);
+        memcpy(maxs_.data() + block * record_size_, row, record_size_);
+    }
+
+    void widen(size_t block, const char *row)
+    {
+        char *min = mins_.data() + block * record_size_;
+        char *max = maxs_.data() + block * record_size_;
+        for (const auto &col : cols_)
+        {
+            const char *value = row + col.offset;
+            if (compare(col, value, min + col.offset) < 0)
+            {
+                memcpy(min + col.offset, value, col.len);
+            }
+            if (compare(col, value, max + col.offset) > 0)
+            {
+                memcpy(max + col.offset, value, col.len);
+            }
+        }
+    }
+
+    // 与 Gap 的比较方式一致：字符串按字节比较
+    static int compare(const ColMeta &col, const char *a, const char *b)
+    {
+        switch (col.type)
+        {
+        case TYPE_INT:
+        {
+            int ia, ib;
+            memcpy(&ia, a, sizeof(int));
+            memcpy(&ib, b, sizeof(int));
+            return (ia > ib) - (ia < ib);
+        }
+        case TYPE_FLOAT:
+        {
+            float fa, fb;
+            memcpy(&fa, a, sizeof(float));
+            memcpy(&fb, b, sizeof(float));
+            return (fa > fb) - (fa < fb);
+        }
+        default:
+            return memcmp(a, b, col.len);
+        }
+    }
+
+    std::vector<ColMeta> cols_;
+    size_t record_size_;
+    std::vector<char> mins_;
+    std::vector<char> maxs_;
+    size_t valid_blocks_ = 0; // 前 valid_blocks_ 块的范围有效
+    std::mutex latch_;
+};
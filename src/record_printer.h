@@ -1,13 +1,18 @@
 #pragma once
 
 #include <cassert>
+#include <cfloat>
+#include <charconv>
+#include <climits>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 #include "common/config_finals.h"
 #include "common/context_finals.h"
+#include "common/output_writer_finals.h"
 
 static const char *print_separator_str = "+------------------";
 
@@ -17,6 +22,9 @@ static const char *print_record_str = "|                  ";
 
 static const int print_record_str_len = strlen(print_record_str);
 
+// format_value 使用的缓冲区大小，足以容纳 FLT_MAX 的定点表示
+static constexpr size_t VALUE_FORMAT_BUF_SIZE = 64;
+
 class RecordPrinter
 {
     size_t num_cols;
@@ -44,15 +52,85 @@ public:
         }
         for (const auto &col : rec_str)
         {
-            memcpy(context->data_send_ + *(context->offset_), print_record_str, print_record_str_len);
-            memcpy(context->data_send_ + *(context->offset_) + print_record_str_len - 1 - col.length(), col.c_str(), col.length());
-            *(context->offset_) = *(context->offset_) + print_record_str_len;
+            print_cell(col, context);
         }
-        std::string str = "|\n";
-        memcpy(context->data_send_ + *(context->offset_), str.c_str(), str.length());
-        *(context->offset_) = *(context->offset_) + str.length();
+        print_record_end(context);
+    }
+
+    // 与上面相同，字段值由 format_value 得到，不构造 std::string
+    static void print_record(const std::string_view *cells, size_t num_cells, Context *context)
+    {
+        if (context->data_send_is_full())
+        {
+            return;
+        }
+        for (size_t i = 0; i < num_cells; i++)
+        {
+            print_cell(cells[i], context);
+        }
+        print_record_end(context);
+    }
+
+    // output.txt 中的一行：| v1 | v2 |
+    static void write_record(const std::string_view *cells, size_t num_cells, OutputBuffer &out)
+    {
+        out.append('|');
+        for (size_t i = 0; i < num_cells; i++)
+        {
+            out.append(' ').append(cells[i]).append(" |");
+        }
+        out.end_line();
     }
 
+    // 字段值的文本：INT_MAX、FLT_MAX 表示空值，输出空串；浮点数与 std::to_string 一样保留 6 位小数
+    // 数字写入 buf（至少 VALUE_FORMAT_BUF_SIZE 字节），字符串直接引用记录中的数据
+    static std::string_view format_value(ColType type, int len, const char *value, char *buf)
+    {
+        switch (type)
+        {
+        case TYPE_INT:
+        {
+            int val;
+            memcpy(&val, value, sizeof(int));
+            if (val == INT_MAX)
+            {
+                return {};
+            }
+            auto res = std::to_chars(buf, buf + VALUE_FORMAT_BUF_SIZE, val);
+            return {buf, static_cast<size_t>(res.ptr - buf)};
+        }
+        case TYPE_FLOAT:
+        {
+            float val;
+            memcpy(&val, value, sizeof(float));
+            if (val == FLT_MAX)
+            {
+                return {};
+            }
+            auto res = std::to_chars(buf, buf + VALUE_FORMAT_BUF_SIZE, val, std::chars_format::fixed, 6);
+            return {buf, static_cast<size_t>(res.ptr - buf)};
+        }
+        default:
+            return {value, strnlen(value, len)};
+        }
+    }
+
+private:
+    // 每个字段占 print_record_str_len 个字符，值右对齐
+    static void print_cell(std::string_view col, Context *context)
+    {
+        memcpy(context->data_send_ + *(context->offset_), print_record_str, print_record_str_len);
+        memcpy(context->data_send_ + *(context->offset_) + print_record_str_len - 1 - col.length(), col.data(), col.length());
+        *(context->offset_) = *(context->offset_) + print_record_str_len;
+    }
+
+    static void print_record_end(Context *context)
+    {
+        memcpy(context->data_send_ + *(context->offset_), "|\n", 2);
+        *(context->offset_) = *(context->offset_) + 2;
+    }
+
+public:
     static void print_record_count(size_t num_rec, Context *context)
     {
         if (context->data_send_is_full())
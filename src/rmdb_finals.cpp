@@ -1,25 +1,37 @@
 #define NDEBUG
 
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <sys/epoll.h>
 #include <sys/resource.h>
 #include <unistd.h>
 
 #include <atomic>
-#include <csetjmp>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
 #include <cstdlib>
+#include <deque>
 #include <iomanip>
+#include <mutex>
+#include <optional>
 #include <regex>
+#include <thread>
 
 #include "analyze/analyze_finals.h"
+#include "common/output_writer_finals.h"
 #include "errors_finals.h"
+#include "fast_path_finals.h"
 #include "optimizer/optimizer_finals.h"
 #include "optimizer/plan_finals.h"
 #include "optimizer/planner_finals.h"
+#include "plan_cache_finals.h"
 #include "portal_finals.h"
 #include "storage/memory_pool_manager.h"
 
 #define SOCK_PORT 8765
 #define MAX_CONN_LIMIT 256
+#define MAX_EPOLL_EVENTS 256
 
 static bool should_exit = false;
 
@@ -32,11 +44,7 @@ auto optimizer = std::make_unique<Optimizer>(planner.get());
 auto ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get(), planner.get());
 auto portal = std::make_unique<Portal>(sm_manager.get());
 auto analyze = std::make_unique<Analyze>(sm_manager.get());
-
-pthread_mutex_t *buffer_mutex;
-pthread_mutex_t *sockfd_mutex;
-
-static jmp_buf jmpbuf;
+auto fast_path = std::make_unique<FastPath>(sm_manager.get());
 
 int Context::MAX_OFFSET_LENGTH = BUFFER_LENGTH >> 1;
 
@@ -51,132 +59,370 @@ void SetTransaction(txn_id_t *txn_id, Context *context)
     }
 }
 
-bool run_sql_command(int &fd, int &txn_id, char *data_recv, char *data_send)
+// 一个客户端连接的状态，没有语句在执行时只占用这几个字段
+struct Session
+{
+    int fd;
+    txn_id_t txn_id = INVALID_TXN_ID;
+    bool stream = false;
+    SqlParser parser;    // 连接独占的扫描器，各连接的语句可以同时解析
+    std::string pending; // 已收到、还没有结束符 '\0' 的语句
+    std::string reply;   // 已执行的语句还没有写到连接上的回复
+    PlanCache plan_cache{sm_manager.get(), analyze.get(), optimizer.get()}; // 连接中 PREPARE 的语句
+    bool resume = false;     // 从 pending 开头的语句继续执行（等待锁后或回复写出后），不先读取连接
+    int wait_fd = -1;        // 语句等待的锁所在的表
+    uint64_t wait_epoch = 0; // 语句等待锁时的 LockManager::release_epoch(wait_fd)
+};
+
+// run_sql_command 的结果：语句已执行、收到 exit、语句需要等待锁（修改已撤销，没有回复）
+enum class CommandResult
+{
+    DONE,
+    EXIT,
+    WAIT,
+};
+
+// 执行一条语句，回复（以 '\0' 结尾）追加到 reply 中，由调用者合并发送
+CommandResult run_sql_command(Session &session, StatementArena &arena, std::string &reply, char *data_recv, char *data_send)
 {
     if (strcmp(data_recv, "exit") == 0)
     {
-        return false;
+        return CommandResult::EXIT;
     }
 
+    // 语法树、Query 和 Plan 从工作线程的内存池分配，函数返回时一起释放
+    StatementArena::Scope arena_scope(&arena);
+
     memset(data_send, '\0', BUFFER_LENGTH);
     int offset = 0;
 
     auto *context = new Context(lock_manager.get(), nullptr, data_send, &offset);
-    SetTransaction(&txn_id, context);
+    context->sockfd_ = session.fd;
+    context->stream_ = session.stream;
+    context->reply_ = &reply;
+    SetTransaction(&session.txn_id, context);
+    size_t savepoint = context->txn_->write_set_.size();
 
-    bool finish_analyze = false;
-    pthread_mutex_lock(buffer_mutex);
-    YY_BUFFER_STATE buf = yy_scan_string(data_recv);
-    if (yyparse() == 0)
+    bool parsed = true;
+    try
     {
-        if (ast::parse_tree != nullptr)
+        // INSERT 和按索引列的点查询由快速路径直接生成算子，其他语句经过完整的解析、分析和优化
+        std::shared_ptr<PortalStmt> portalStmt = fast_path->start(data_recv, context);
+        if (portalStmt == nullptr)
         {
-            try
+            // 预备语句的语法树在语句结束后仍要保留，以 PREPARE 开头的语句直接在堆上解析
+            std::optional<StatementArena::Scope> heap_scope;
+            if (FastPath::starts_with(data_recv, "PREPARE"))
             {
-                std::shared_ptr<Query> query = analyze->do_analyze(ast::parse_tree);
-                yy_delete_buffer(buf);
-                finish_analyze = true;
-                pthread_mutex_unlock(buffer_mutex);
-                std::shared_ptr<Plan> plan = optimizer->plan_query(query, context);
-                std::shared_ptr<PortalStmt> portalStmt = portal->start(plan, context);
-                portal->run(portalStmt, ql_manager.get(), &txn_id, context);
+                heap_scope.emplace(nullptr);
             }
-            catch (TransactionAbortException &e)
+            std::shared_ptr<ast::TreeNode> parse_tree;
+            parsed = session.parser.parse(data_recv, parse_tree);
+            if (!parsed || parse_tree == nullptr)
             {
-                std::string str = "abort\n";
-                memcpy(data_send, str.c_str(), str.length());
-                data_send[str.length()] = '\0';
-                offset = str.length();
-
-                txn_manager->abort(context->txn_);
-
-                if (sm_manager->io_enabled_)
+                // 语法错误或空语句，不执行
+            }
+            // 预备语句在连接的计划缓存中生成、绑定参数和删除
+            else if (auto x = std::dynamic_pointer_cast<ast::PrepareStmt>(parse_tree))
+            {
+                // 注释开头的 PREPARE 语句在内存池中解析，需要在堆上重新解析
+                if (!heap_scope)
                 {
-                    std::fstream outfile;
-                    outfile.open("output.txt", std::ios::out | std::ios::app);
-                    outfile << str;
-                    outfile.close();
+                    heap_scope.emplace(nullptr);
+                    session.parser.parse(data_recv, parse_tree);
+                    x = std::dynamic_pointer_cast<ast::PrepareStmt>(parse_tree);
                 }
+                session.plan_cache.prepare(x->name, x->stmt, context);
             }
-            catch (RMDBError &e)
+            else if (auto x = std::dynamic_pointer_cast<ast::ExecuteStmt>(parse_tree))
             {
-                if (sm_manager->io_enabled_)
+                portalStmt = portal->start(session.plan_cache.bind(x->name, x->vals, context), context);
+            }
+            else if (auto x = std::dynamic_pointer_cast<ast::DeallocateStmt>(parse_tree))
+            {
+                session.plan_cache.deallocate(x->name);
+            }
+            else
+            {
+                std::shared_ptr<Query> query = analyze->do_analyze(parse_tree);
+                // 占位符只能出现在 PREPARE 的语句中
+                if (query->param_num > 0)
                 {
-                    std::fstream outfile;
-                    outfile.open("output.txt", std::ios::out | std::ios::app);
-                    outfile << "failure\n";
-                    outfile.close();
+                    throw RMDBError();
                 }
+                std::shared_ptr<Plan> plan = optimizer->plan_query(query, context);
+                portalStmt = portal->start(plan, context);
             }
         }
+        if (portalStmt != nullptr)
+        {
+            portal->run(portalStmt, ql_manager.get(), &session.txn_id, context);
+        }
     }
-    else
+    catch (TransactionWaitException &e)
     {
+        // 撤销这条语句的修改，事务和已加的锁保留，连接在有锁释放后重新执行这条语句，期间不占用工作线程
+        txn_manager->rollback(context->txn_, savepoint);
+        session.wait_fd = e.fd_;
+        session.wait_epoch = e.epoch_;
+        delete context;
+        return CommandResult::WAIT;
+    }
+    catch (TransactionAbortException &e)
+    {
+        std::string str = "abort\n";
+        memcpy(data_send, str.c_str(), str.length());
+        data_send[str.length()] = '\0';
+        offset = str.length();
+
+        txn_manager->abort(context->txn_);
+
         if (sm_manager->io_enabled_)
         {
-            std::fstream outfile;
-            outfile.open("output.txt", std::ios::out | std::ios::app);
-            outfile << "failure\n";
-            outfile.close();
+            OutputWriter::instance().write(str);
         }
     }
-    if (!finish_analyze)
+    catch (RMDBError &e)
     {
-        yy_delete_buffer(buf);
-        pthread_mutex_unlock(buffer_mutex);
+        if (sm_manager->io_enabled_)
+        {
+            OutputWriter::instance().write("failure\n");
+        }
     }
-    if (write(fd, data_send, offset + 1) == -1)
+    if (!parsed && sm_manager->io_enabled_)
     {
-        return false;
+        OutputWriter::instance().write("failure\n");
     }
+    session.stream = context->stream_;
+    reply.append(data_send, offset);
+    reply.push_back('\0');
     if (!context->txn_->get_txn_mode())
     {
         txn_manager->commit(context->txn_);
     }
     delete context;
-    return true;
+    return CommandResult::DONE;
 }
 
-void *client_handler(void *sock_fd)
+// 事件循环与工作线程：主线程用 epoll 等待新连接和可读的连接，可读的连接交给固定数量的工作线程执行语句
+// 连接以 EPOLLONESHOT 注册，同一连接同时只有一个工作线程处理，处理完收到的语句后重新注册
+// 语句以 '\0' 结尾，一次收到的多条语句按顺序执行，回复合并后一次发送，客户端可以不等回复连续发送语句
+// 连接不阻塞，客户端读得慢时没有写出的回复留在连接中，注册 EPOLLOUT 等连接可写时再发送，工作线程不阻塞在 write 上
+// 需要等待锁的语句不阻塞工作线程：连接按等待的表挂起，这张表上有锁释放后重新加入就绪队列，从这条语句继续执行
+class Server
 {
-    int fd = *((int *)sock_fd);
-    pthread_mutex_unlock(sockfd_mutex);
+public:
+    explicit Server(int listen_fd) : listen_fd_(listen_fd)
+    {
+        epoll_fd_ = epoll_create1(0);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event);
+        lock_manager->set_release_callback([this](int fd)
+                                           { wake_parked(fd); });
+        size_t worker_num = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < worker_num; i++)
+        {
+            std::thread(&Server::work, this).detach();
+        }
+    }
 
-    char data_recv[BUFFER_LENGTH];
-    char data_send[BUFFER_LENGTH];
-    txn_id_t txn_id = INVALID_TXN_ID;
+    void run()
+    {
+        epoll_event events[MAX_EPOLL_EVENTS];
+        while (!should_exit)
+        {
+            int n = epoll_wait(epoll_fd_, events, MAX_EPOLL_EVENTS, -1);
+            for (int i = 0; i < n; i++)
+            {
+                auto session = static_cast<Session *>(events[i].data.ptr);
+                if (session == nullptr)
+                {
+                    accept_all();
+                    continue;
+                }
+                {
+                    std::lock_guard lock(latch_);
+                    ready_.push_back(session);
+                }
+                cv_.notify_one();
+            }
+        }
+    }
+
+private:
+    // 连接处理后的去向
+    enum class ServeResult
+    {
+        REARM, // 重新注册，等待新的数据
+        WRITE, // 还有没有写出的回复，或者回复写出后还要继续执行 pending 中的语句，等待连接可写
+        PARK,  // 语句等待锁
+        CLOSE,
+    };
 
-    while (true)
+    void accept_all()
     {
-        memset(data_recv, 0, BUFFER_LENGTH);
-        auto i_recvBytes = read(fd, data_recv, BUFFER_LENGTH);
-        if (i_recvBytes == 0)
+        while (true)
         {
-            return nullptr;
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd == -1)
+            {
+                return;
+            }
+            auto session = new Session{fd};
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLONESHOT;
+            event.data.ptr = session;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
         }
-        if (i_recvBytes == -1)
+    }
+
+    // 工作线程的缓冲区和内存池在各连接之间复用
+    void work()
+    {
+        std::vector<char> data_recv(RECV_BUFFER_SIZE);
+        char data_send[BUFFER_LENGTH];
+        StatementArena arena;
+        while (true)
         {
-            return nullptr;
+            Session *session;
+            {
+                std::unique_lock lock(latch_);
+                cv_.wait(lock, [&]
+                         { return !ready_.empty(); });
+                session = ready_.front();
+                ready_.pop_front();
+            }
+            auto result = serve(session, arena, data_recv, data_send);
+            if (result == ServeResult::CLOSE)
+            {
+                close(session->fd);
+                delete session;
+                continue;
+            }
+            if (result == ServeResult::PARK)
+            {
+                park(session);
+                continue;
+            }
+            epoll_event event{};
+            event.events = (result == ServeResult::WRITE ? EPOLLOUT : EPOLLIN) | EPOLLONESHOT;
+            event.data.ptr = session;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, session->fd, &event);
+        }
+    }
+
+    // 先发送之前没有写出的回复，再读取连接上的数据并执行其中完整的语句；
+    // 等待锁后恢复或回复写出后继续的连接不读取，从 pending 开头的语句继续
+    static ServeResult serve(Session *session, StatementArena &arena, std::vector<char> &data_recv, char *data_send)
+    {
+        auto &pending = session->pending;
+        auto &reply = session->reply;
+        if (!Context::send_some(session->fd, reply))
+        {
+            return ServeResult::CLOSE;
+        }
+        if (!reply.empty())
+        {
+            return ServeResult::WRITE;
         }
-        if (!run_sql_command(fd, txn_id, data_recv, data_send))
+        if (!session->resume)
         {
-            return nullptr;
+            auto i_recvBytes = read(session->fd, data_recv.data(), data_recv.size());
+            if (i_recvBytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            {
+                return ServeResult::REARM;
+            }
+            if (i_recvBytes <= 0)
+            {
+                return ServeResult::CLOSE;
+            }
+            pending.append(data_recv.data(), i_recvBytes);
         }
+        session->resume = false;
+        auto result = CommandResult::DONE;
+        size_t begin = 0;
+        for (size_t end; result == CommandResult::DONE && (end = pending.find('\0', begin)) != std::string::npos;)
+        {
+            result = run_sql_command(*session, arena, reply, pending.data() + begin, data_send);
+            // 等待锁的语句留在 pending 中，之前语句的回复照常发送
+            if (result == CommandResult::WAIT)
+            {
+                break;
+            }
+            begin = end + 1;
+            if (reply.size() >= REPLY_FLUSH_SIZE)
+            {
+                if (!Context::send_some(session->fd, reply))
+                {
+                    return ServeResult::CLOSE;
+                }
+                // 客户端读得慢，回复积压时先不执行后面的语句，连接可写后继续
+                if (reply.size() >= REPLY_FLUSH_SIZE)
+                {
+                    session->resume = true;
+                    break;
+                }
+            }
+        }
+        pending.erase(0, begin);
+        if (!Context::send_some(session->fd, reply) || result == CommandResult::EXIT)
+        {
+            return ServeResult::CLOSE;
+        }
+        if (result == CommandResult::WAIT)
+        {
+            return ServeResult::PARK;
+        }
+        return reply.empty() && !session->resume ? ServeResult::REARM : ServeResult::WRITE;
     }
-}
+
+    // 挂起等待锁的连接；语句发现冲突之后这张表上已有锁释放时直接重新加入就绪队列
+    void park(Session *session)
+    {
+        std::lock_guard lock(latch_);
+        session->resume = true;
+        if (lock_manager->release_epoch(session->wait_fd) != session->wait_epoch)
+        {
+            ready_.push_back(session);
+            cv_.notify_one();
+            return;
+        }
+        parked_[session->wait_fd].push_back(session);
+    }
+
+    // 表 fd 上有锁释放时调用，等待这张表的连接重新执行等待的语句，仍然冲突的再次挂起
+    void wake_parked(int fd)
+    {
+        {
+            std::lock_guard lock(latch_);
+            auto &parked = parked_[fd];
+            if (parked.empty())
+            {
+                return;
+            }
+            ready_.insert(ready_.end(), parked.begin(), parked.end());
+            parked.clear();
+        }
+        cv_.notify_all();
+    }
+
+    int listen_fd_;
+    int epoll_fd_;
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::deque<Session *> ready_;   // 可读或可写、等待工作线程处理的连接
+    std::vector<Session *> parked_[MAX_TABLE_NUMBER]; // 按表分组的等待锁释放的连接
+};
 
 void start_server()
 {
-    buffer_mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
-    sockfd_mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
-    pthread_mutex_init(buffer_mutex, nullptr);
-    pthread_mutex_init(sockfd_mutex, nullptr);
-
     int sockfd_server;
     int fd_temp;
     struct sockaddr_in s_addr_in;
 
-    sockfd_server = socket(AF_INET, SOCK_STREAM, 0);
+    sockfd_server = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
     assert(sockfd_server != -1);
     int val = 1;
     setsockopt(sockfd_server, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val));
@@ -197,35 +443,35 @@ void start_server()
         exit(0);
     }
 
-    while (!should_exit)
-    {
-        pthread_t thread_id;
-        struct sockaddr_in s_addr_client
-        {
-        };
-        int client_length = sizeof(s_addr_client);
-
-        if (setjmp(jmpbuf))
-        {
-            break;
-        }
-
-        pthread_mutex_lock(sockfd_mutex);
-        int sockfd = accept(sockfd_server, (struct sockaddr *)(&s_addr_client), (socklen_t *)(&client_length));
-        if (sockfd == -1)
-        {
-            continue;
-        }
+    Server(sockfd_server).run();
+}
 
-        if (pthread_create(&thread_id, nullptr, &client_handler, (void *)(&sockfd)) != 0)
+// output.txt 由后台线程写入，收到 SIGINT/SIGTERM 时先写完队列中的内容再按默认方式结束进程
+// 需要在创建其他线程之前调用，使所有线程都屏蔽这两个信号，只由这里的线程接收
+void start_signal_handler()
+{
+    static sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread([]
+                {
+        int sig;
+        if (sigwait(&signals, &sig) != 0)
         {
-            break;
+            return;
         }
-    }
+        OutputWriter::instance().flush();
+        signal(sig, SIG_DFL);
+        pthread_sigmask(SIG_UNBLOCK, &signals, nullptr);
+        raise(sig); })
+        .detach();
 }
 
 int main(int argc, char **argv)
 {
+    start_signal_handler();
     std::string db_name = argv[1];
     if (!sm_manager->is_dir(db_name))
     {
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/config_finals.h"
+#include "errors_finals.h"
+
+// 算子在内存预算不足时使用的临时溢出文件
+// 文件创建后立即 unlink，进程退出或对象析构时由内核回收，不会在数据库目录里留下垃圾文件
+class SpillFile
+{
+public:
+    SpillFile()
+    {
+        char path[] = "spill_XXXXXX";
+        fd_ = mkstemp(path);
+        if (fd_ == -1)
+        {
+            throw RMDBError();
+        }
+        unlink(path);
+        buffer_.resize(SPILL_BUFFER_SIZE);
+    }
+
+    ~SpillFile()
+    {
+        if (fd_ != -1)
+        {
+            close(fd_);
+        }
+    }
+
+    SpillFile(const SpillFile &) = delete;
+
+    SpillFile &operator=(const SpillFile &) = delete;
+
+    // 追加写入，写满缓冲区后才真正落盘
+    void append(const char *data, size_t len)
+    {
+        while (len > 0)
+        {
+            size_t n = std::min(len, buffer_.size() - buffer_len_);
+            memcpy(buffer_.data() + buffer_len_, data, n);
+            buffer_len_ += n;
+            data += n;
+            len -= n;
+            if (buffer_len_ == buffer_.size())
+            {
+                flush();
+            }
+        }
+    }
+
+    // 结束写入，之后可以从头顺序读取
+    void rewind()
+    {
+        if (!reading_)
+        {
+            flush();
+            reading_ = true;
+        }
+        read_pos_ = 0;
+        buffer_len_ = 0;
+        buffer_pos_ = 0;
+    }
+
+    // 顺序读取 len 字节，文件已读完时返回 false
+    bool read(char *data, size_t len)
+    {
+        while (len > 0)
+        {
+            if (buffer_pos_ == buffer_len_ && !fill())
+            {
+                return false;
+            }
+            size_t n = std::min(len, buffer_len_ - buffer_pos_);
+            memcpy(data, buffer_.data() + buffer_pos_, n);
+            buffer_pos_ += n;
+            data += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    size_t size() const { return write_pos_ + (reading_ ? 0 : buffer_len_); }
+
+private:
+    void flush()
+    {
+        if (buffer_len_ == 0)
+        {
+            return;
+        }
+        if (pwrite(fd_, buffer_.data(), buffer_len_, write_pos_) != (ssize_t)buffer_len_)
+        {
+            throw RMDBError();
+        }
+        write_pos_ += buffer_len_;
+        buffer_len_ = 0;
+    }
+
+    bool fill()
+    {
+        if (read_pos_ >= write_pos_)
+        {
+            return false;
+        }
+        auto n = pread(fd_, buffer_.data(), std::min(buffer_.size(), write_pos_ - read_pos_), read_pos_);
+        if (n <= 0)
+        {
+            throw RMDBError();
+        }
+        read_pos_ += n;
+        buffer_len_ = n;
+        buffer_pos_ = 0;
+        return true;
+    }
+
+    int fd_;
+    std::vector<char> buffer_;
+    size_t buffer_len_ = 0;
+    size_t buffer_pos_ = 0;
+    size_t write_pos_ = 0;
+    size_t read_pos_ = 0;
+    bool reading_ = false;
+};
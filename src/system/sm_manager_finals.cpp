@@ -5,6 +5,7 @@
 
 #include <fstream>
 
+#include "common/output_writer_finals.h"
 #include "record/rm_scan_finals.h"
 #include "record_printer.h"
 
@@ -67,9 +68,7 @@ void SmManager::open_db(const std::string &db_name)
         throw RMDBError();
     }
 
-    std::fstream outfile;
-    outfile.open("output.txt", std::ios::out | std::ios::app);
-    outfile.close();
+    OutputWriter::instance().reopen();
 }
 
 void SmManager::close_db()
@@ -82,6 +81,7 @@ void SmManager::close_db()
     db_.name_.clear();
     db_.tabs_.clear();
 
+    OutputWriter::instance().close();
     if (chdir("..") < 0)
     {
         throw RMDBError();
@@ -90,12 +90,8 @@ void SmManager::close_db()
 
 void SmManager::show_tables(Context *context)
 {
-    std::fstream outfile;
-    if (io_enabled_)
-    {
-        outfile.open("output.txt", std::ios::out | std::ios::app);
-        outfile << "| Tables |\n";
-    }
+    OutputBuffer out(io_enabled_);
+    out.append("| Tables |").end_line();
     RecordPrinter printer(1);
     printer.print_separator(context);
     printer.print_record({"Tables"}, context);
@@ -104,48 +100,30 @@ void SmManager::show_tables(Context *context)
     {
         auto &tab = entry.second;
         printer.print_record({tab->name_}, context);
-        if (io_enabled_)
-        {
-            outfile << "| " << tab->name_ << " |\n";
-        }
+        out.append("| ").append(tab->name_).append(" |").end_line();
     }
     printer.print_separator(context);
-    if (io_enabled_)
-    {
-        outfile.close();
-    }
 }
 
 void SmManager::show_index(const std::string &tab_name, Context *context)
 {
     auto tab = db_.get_table(tab_name);
-    std::fstream outfile;
-    if (io_enabled_)
-    {
-        outfile.open("output.txt", std::ios::out | std::ios::app);
-    }
+    OutputBuffer out(io_enabled_);
     RecordPrinter printer(1);
     printer.print_separator(context);
     printer.print_record({"index"}, context);
     printer.print_separator(context);
     for (auto &index : tab->indexes)
     {
-        if (io_enabled_)
+        out.append("| ").append(tab->name_).append(" | unique | (").append(index.cols_[0].name);
+        for (size_t i = 1; i < index.cols_.size(); ++i)
         {
-            outfile << "| " << tab->name_ << " | unique | (" << index.cols_[0].name;
-            for (size_t i = 1; i < index.cols_.size(); ++i)
-            {
-                outfile << "," << index.cols_[i].name;
-            }
-            outfile << ") |\n";
+            out.append(',').append(index.cols_[i].name);
         }
+        out.append(") |").end_line();
         printer.print_record({get_index_name(tab_name, index.cols_)}, context);
     }
     printer.print_separator(context);
-    if (io_enabled_)
-    {
-        outfile.close();
-    }
 }
 
 void SmManager::desc_table(const std::string &tab_name, Context *context)
@@ -180,8 +158,9 @@ void SmManager::create_table(const std::string &tab_name, const std::vector<ColD
         tab->push_back(col);
     }
     int record_size = curr_offset;
-    fhs_[tab->fd_] = std::make_unique<RmFileHandle>(record_size);
+    fhs_[tab->fd_] = std::make_unique<RmFileHandle>(record_size, tab->cols);
     db_.tabs_[tab_name] = std::move(tab);
+    db_.version_++;
 }
 
 void SmManager::drop_table(const std::string &tab_name, Context *context)
@@ -191,6 +170,7 @@ void SmManager::drop_table(const std::string &tab_name, Context *context)
         throw RMDBError();
     }
     db_.tabs_.erase(tab_name);
+    db_.version_++;
 }
 
 void SmManager::create_index(const std::string &tab_name, const std::vector<std::string> &col_names, Context *context)
@@ -219,6 +199,7 @@ void SmManager::create_index(const std::string &tab_name, const std::vector<std:
     }
     ihs_[indexMeta.fd_] = std::move(ih);
     tab->push_back(indexMeta);
+    db_.version_++;
 }
 
 void SmManager::drop_index(const std::string &tab_name, const std::vector<std::string> &col_names, Context *context)
@@ -230,6 +211,7 @@ void SmManager::drop_index(const std::string &tab_name, const std::vector<std::s
     }
     auto index_name = get_index_name(tab_name, col_names);
     tab->erase_index(index_name);
+    db_.version_++;
 }
 
 void SmManager::drop_index(const std::string &tab_name, const std::vector<ColMeta> &cols, Context *context)
@@ -0,0 +1,151 @@
+// 快速路径的基准：同样形式的 INSERT 和点查询分别经过完整流程（flex/bison、Analyze、Optimizer、Portal::start）和 FastPath::start，
+// 比较生成算子树（plan）和整条语句（total）的平均耗时。INSERT 在生成算子时完成插入，它的 plan 包含插入本身
+// 用法：fast_path_bench [语句数]，在临时目录中建库；两条路径查询到的结果不同时返回 1
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "analyze/analyze_finals.h"
+#include "fast_path_finals.h"
+#include "optimizer/optimizer_finals.h"
+
+int Context::MAX_OFFSET_LENGTH = BUFFER_LENGTH >> 1;
+
+static PoolManager memory_pool_manager;
+static SmManager sm_manager(&memory_pool_manager);
+static LockManager lock_manager(&memory_pool_manager);
+static TransactionManager txn_manager(&sm_manager, &lock_manager);
+static Planner planner(&sm_manager);
+static Optimizer optimizer(&planner);
+static QlManager ql_manager(&sm_manager, &txn_manager, &planner);
+static Portal portal(&sm_manager);
+static Analyze analyze(&sm_manager);
+static FastPath fast_path(&sm_manager);
+static SqlParser parser;
+static StatementArena arena;
+static char data_send[BUFFER_LENGTH];
+
+struct Timing
+{
+    double plan_us = 0;
+    double total_us = 0;
+};
+
+// 执行一条自动提交的语句，返回发给客户端的内容
+static std::string run(const std::string &sql, bool fast, Timing &timing)
+{
+    // 与服务器相同，语法树、Query 和 Plan 从语句级内存池分配
+    StatementArena::Scope arena_scope(&arena);
+    int offset = 0;
+    Context context(&lock_manager, txn_manager.begin(nullptr), data_send, &offset);
+    context.txn_->set_txn_mode(false);
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<PortalStmt> portal_stmt;
+    if (fast)
+    {
+        portal_stmt = fast_path.start(sql.c_str(), &context);
+    }
+    else
+    {
+        std::shared_ptr<ast::TreeNode> parse_tree;
+        if (parser.parse(sql.c_str(), parse_tree) && parse_tree != nullptr)
+        {
+            portal_stmt = portal.start(optimizer.plan_query(analyze.do_analyze(parse_tree), &context), &context);
+        }
+    }
+    auto planned = std::chrono::steady_clock::now();
+    if (portal_stmt == nullptr)
+    {
+        fprintf(stderr, "%s path rejected: %s\n", fast ? "fast" : "full", sql.c_str());
+        exit(1);
+    }
+    txn_id_t txn_id = context.txn_->txn_id_;
+    Portal::run(portal_stmt, &ql_manager, &txn_id, &context);
+    txn_manager.commit(context.txn_);
+    auto end = std::chrono::steady_clock::now();
+
+    timing.plan_us += std::chrono::duration<double, std::micro>(planned - start).count();
+    timing.total_us += std::chrono::duration<double, std::micro>(end - start).count();
+    return std::string(data_send, offset);
+}
+
+static void report(const char *name, const Timing &timing, size_t stmt_num)
+{
+    printf("%-12s plan %8.3f us/stmt  total %8.3f us/stmt\n", name, timing.plan_us / stmt_num, timing.total_us / stmt_num);
+}
+
+static std::string insert_sql(size_t id)
+{
+    return "insert into t values (" + std::to_string(id) + ", 'name" + std::to_string(id) + "', " + std::to_string(id) + ".5);";
+}
+
+static std::string select_sql(size_t id) { return "select id, name, score from t where id = " + std::to_string(id) + ";"; }
+
+int main(int argc, char **argv)
+{
+    size_t stmt_num = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+
+    char dir[] = "/tmp/fast_path_bench.XXXXXX";
+    if (mkdtemp(dir) == nullptr || chdir(dir) < 0)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+    sm_manager.create_db("db");
+    sm_manager.open_db("db");
+    sm_manager.io_enabled_ = false;
+    Timing ddl;
+    run("create table t (id int, name char(16), score float);", false, ddl);
+    run("create index t(id);", false, ddl);
+
+    printf("statements %zu\n", stmt_num);
+    Timing full_insert, fast_insert;
+    for (size_t i = 0; i < stmt_num; i++)
+    {
+        run(insert_sql(i), false, full_insert);
+    }
+    for (size_t i = stmt_num; i < 2 * stmt_num; i++)
+    {
+        run(insert_sql(i), true, fast_insert);
+    }
+    report("insert-full", full_insert, stmt_num);
+    report("insert-fast", fast_insert, stmt_num);
+
+    std::mt19937 rng(2024);
+    std::vector<size_t> ids(stmt_num);
+    for (auto &id : ids)
+    {
+        id = rng() % (2 * stmt_num);
+    }
+    Timing full_select, fast_select;
+    std::vector<std::string> expect(stmt_num);
+    for (size_t i = 0; i < stmt_num; i++)
+    {
+        expect[i] = run(select_sql(ids[i]), false, full_select);
+    }
+    bool ok = true;
+    for (size_t i = 0; i < stmt_num; i++)
+    {
+        ok &= run(select_sql(ids[i]), true, fast_select) == expect[i];
+    }
+    report("select-full", full_select, stmt_num);
+    report("select-fast", fast_select, stmt_num);
+
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (chdir("/") < 0 || system(cmd.c_str()) != 0)
+    {
+        perror("rm");
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "select results mismatch\n");
+        return 1;
+    }
+    return 0;
+}
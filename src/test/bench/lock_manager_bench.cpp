@@ -0,0 +1,166 @@
+// 锁管理器的基准：表上已有不同数量的锁时，多个线程各自反复开始事务、加一个间隙锁和若干数据锁、释放，统计每个事务的平均耗时。
+// 各线程使用互不相交的字段值，不发生冲突；开始前检查与已有锁相交的间隙锁和数据锁会让较新的事务回滚
+// 用法：lock_manager_bench [每个线程的事务数]，冲突检查不符合预期时返回 1
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "transaction/concurrency/lock_manager_finals.h"
+
+std::atomic<int> NameManager::uuid{0};
+std::string NameManager::fd2name[MAX_TABLE_NUMBER];
+std::unordered_map<std::string, int> NameManager::name2fd;
+
+static constexpr int STR_LEN = 16;
+static constexpr int FD = 0;
+static constexpr int DATA_LOCKS_PER_TXN = 4;
+
+static PoolManager pool;
+static LockManager lock_manager(&pool);
+static std::atomic<txn_id_t> next_txn_id{1};
+
+static char *make_row(const TabMeta &tab, int a)
+{
+    char *row = pool.allocate(tab.col_tot_len);
+    memset(row, 0, tab.col_tot_len);
+    float b = static_cast<float>(a) / 2;
+    memcpy(row, &a, sizeof(int));
+    memcpy(row + sizeof(int), &b, sizeof(float));
+    snprintf(row + sizeof(int) + sizeof(float), STR_LEN, "%015d", a);
+    return row;
+}
+
+// 间隙 lower <= a <= upper
+static Gap *lock_gap(TabMeta &tab, const std::shared_ptr<Transaction> &txn, int lower, int upper)
+{
+    char *lower_key = pool.allocate(tab.col_tot_len);
+    char *upper_key = pool.allocate(tab.col_tot_len);
+    memcpy(lower_key, &lower, sizeof(int));
+    memcpy(upper_key, &upper, sizeof(int));
+    std::vector<int> closed(tab.cols.size(), 1);
+    return lock_manager.lock_shared_on_gap(txn, FD, &tab, upper_key, lower_key, closed, closed, {0});
+}
+
+static bool aborts(const std::function<void()> &fn)
+{
+    try
+    {
+        fn();
+    }
+    catch (TransactionAbortException &)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    size_t txn_num = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000;
+
+    // 表 t(a INT, b FLOAT, s CHAR(16))
+    TabMeta tab("lock_manager_bench");
+    tab.push_back(ColMeta(tab.name_, "a", TYPE_INT, ast::default_type, sizeof(int), 0, false, 0));
+    tab.push_back(ColMeta(tab.name_, "b", TYPE_FLOAT, ast::default_type, sizeof(float), sizeof(int), false, 1));
+    tab.push_back(ColMeta(tab.name_, "s", TYPE_STRING, ast::default_type, STR_LEN, sizeof(int) + sizeof(float), false, 2));
+
+    // 已有的锁：持有者各有 100 个单点间隙锁（a 为偶数）和 100 个数据锁（a 为奇数），共 held 个，字段值都小于 1000000
+    std::vector<std::shared_ptr<Transaction>> holders;
+    std::vector<char *> rows;
+    size_t held = 0;
+    bool ok = true;
+    printf("threads %u, txns per thread %zu, %d data locks per txn\n", std::thread::hardware_concurrency(), txn_num, DATA_LOCKS_PER_TXN);
+    for (size_t target : {0, 1000, 10000, 100000})
+    {
+        while (held < target)
+        {
+            auto holder = std::make_shared<Transaction>(next_txn_id++);
+            for (int i = 0; i < 100; i++, held += 2)
+            {
+                int a = static_cast<int>(held);
+                lock_gap(tab, holder, a, a);
+                rows.push_back(make_row(tab, a + 1));
+                lock_manager.lock_exclusive_on_data(holder, FD, rows.back());
+            }
+            holders.push_back(std::move(holder));
+        }
+
+        if (held > 0)
+        {
+            // 较新的事务与已有的数据锁、间隙锁冲突时回滚，与不相交的范围不冲突
+            auto txn = std::make_shared<Transaction>(next_txn_id++);
+            char *conflict_row = make_row(tab, 0);
+            char *free_row = make_row(tab, static_cast<int>(held) + 10);
+            ok &= aborts([&]
+                         { lock_gap(tab, txn, 1, 1); });
+            ok &= aborts([&]
+                         { lock_manager.lock_exclusive_on_data(txn, FD, conflict_row); });
+            ok &= !aborts([&]
+                          { lock_gap(tab, txn, static_cast<int>(held) + 1, static_cast<int>(held) + 100); });
+            ok &= !aborts([&]
+                          { lock_manager.lock_exclusive_on_data(txn, FD, free_row); });
+            lock_manager.unlock(txn);
+            pool.deallocate(conflict_row, tab.col_tot_len);
+            pool.deallocate(free_row, tab.col_tot_len);
+        }
+
+        for (unsigned thread_num : {1u, 2u, 4u, 8u})
+        {
+            std::vector<std::thread> threads;
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned t = 0; t < thread_num; t++)
+            {
+                threads.emplace_back([&, t]
+                                     {
+                    int base = 1000000 + static_cast<int>(t) * 10000000;
+                    std::vector<char *> txn_rows;
+                    for (int i = 0; i < DATA_LOCKS_PER_TXN; i++)
+                    {
+                        txn_rows.push_back(make_row(tab, base + i + 1));
+                    }
+                    for (size_t i = 0; i < txn_num; i++)
+                    {
+                        auto txn = std::make_shared<Transaction>(next_txn_id++);
+                        lock_gap(tab, txn, base, base);
+                        for (auto row : txn_rows)
+                        {
+                            lock_manager.lock_exclusive_on_data(txn, FD, row);
+                        }
+                        lock_manager.unlock(txn);
+                    }
+                    for (auto row : txn_rows)
+                    {
+                        pool.deallocate(row, tab.col_tot_len);
+                    } });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+            auto end = std::chrono::steady_clock::now();
+            double us = std::chrono::duration<double, std::micro>(end - start).count();
+            printf("held %7zu  threads %u  %8.3f us/txn  %8.1f ktxn/s\n", held, thread_num, us / (txn_num * thread_num), txn_num * thread_num / us * 1000);
+        }
+    }
+
+    for (auto &holder : holders)
+    {
+        lock_manager.unlock(holder);
+    }
+    for (auto row : rows)
+    {
+        pool.deallocate(row, tab.col_tot_len);
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "conflict check mismatch\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// 顺序扫描过滤的微基准：比较逐行 Gap::overlap、批量过滤的标量实现和 AVX2 实现
+// 用法：scan_filter_bench [记录数] [重复次数]，三种方式选出的记录不同时返回 1
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "transaction/concurrency/lock_manager_finals.h"
+
+std::atomic<int> NameManager::uuid{0};
+std::string NameManager::fd2name[MAX_TABLE_NUMBER];
+std::unordered_map<std::string, int> NameManager::name2fd;
+
+static constexpr int STR_LEN = 16;
+
+template <typename Filter>
+static size_t run(const char *name, const std::vector<char *> &rows, int repeat, Filter &&filter)
+{
+    size_t selected = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++)
+    {
+        selected = filter();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / repeat;
+    printf("%-14s %10.3f ms  %8.2f Mrows/s  selected %zu\n", name, ms, rows.size() / ms / 1000, selected);
+    return selected;
+}
+
+int main(int argc, char **argv)
+{
+    size_t row_num = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1 << 20;
+    int repeat = argc > 2 ? atoi(argv[2]) : 20;
+
+    // 表 t(a INT, b FLOAT, s CHAR(16))，条件 100 <= a < 600 AND 0.25 < b <= 0.75
+    TabMeta tab("scan_filter_bench");
+    tab.push_back(ColMeta(tab.name_, "a", TYPE_INT, ast::default_type, sizeof(int), 0, false, 0));
+    tab.push_back(ColMeta(tab.name_, "b", TYPE_FLOAT, ast::default_type, sizeof(float), sizeof(int), false, 1));
+    tab.push_back(ColMeta(tab.name_, "s", TYPE_STRING, ast::default_type, STR_LEN, sizeof(int) + sizeof(float), false, 2));
+
+    std::mt19937 rng(2024);
+    std::vector<char> data(row_num * tab.col_tot_len);
+    std::vector<char *> rows(row_num);
+    for (size_t i = 0; i < row_num; i++)
+    {
+        char *row = data.data() + i * tab.col_tot_len;
+        int a = static_cast<int>(rng() % 1000);
+        float b = static_cast<float>(rng() % 10000) / 10000;
+        memcpy(row, &a, sizeof(a));
+        memcpy(row + sizeof(int), &b, sizeof(b));
+        snprintf(row + sizeof(int) + sizeof(float), STR_LEN, "%015zu", i % 1000000000);
+        rows[i] = row;
+    }
+
+    PoolManager pool;
+    char *lower = pool.allocate(tab.col_tot_len);
+    char *upper = pool.allocate(tab.col_tot_len);
+    int a_low = 100, a_up = 600;
+    float b_low = 0.25f, b_up = 0.75f;
+    memcpy(lower, &a_low, sizeof(int));
+    memcpy(upper, &a_up, sizeof(int));
+    memcpy(lower + sizeof(int), &b_low, sizeof(float));
+    memcpy(upper + sizeof(int), &b_up, sizeof(float));
+    Gap gap(&tab, upper, lower, {0, 1}, {1, 0}, {0, 1}, &pool);
+
+    auto batch_filter = [&]
+    {
+        size_t selected = 0;
+        for (size_t begin = 0; begin < row_num; begin += simd_filter::SIMD_FILTER_BATCH)
+        {
+            size_t n = std::min(simd_filter::SIMD_FILTER_BATCH, row_num - begin);
+            selected += __builtin_popcountll(gap.overlap_batch(rows.data() + begin, n));
+        }
+        return selected;
+    };
+
+    printf("rows %zu, repeat %d, avx2 %s\n", row_num, repeat, simd_filter::avx2_enabled() ? "supported" : "unsupported");
+    size_t expect = run("per-row", rows, repeat, [&]
+                        {
+        size_t selected = 0;
+        for (auto row : rows)
+        {
+            selected += gap.overlap(row);
+        }
+        return selected; });
+
+    bool avx2 = simd_filter::avx2_enabled();
+    simd_filter::avx2_enabled() = false;
+    bool ok = run("batch-scalar", rows, repeat, batch_filter) == expect;
+    if (avx2)
+    {
+        simd_filter::avx2_enabled() = true;
+        ok &= run("batch-avx2", rows, repeat, batch_filter) == expect;
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "selected rows mismatch\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <random>  // for std::default_random_engine
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "index/btree.h"
+
+// 内存 B+ 树 btree_set 的测试：大量重复键使同一个键跨越多个叶子节点和中间节点，
+// 检查 lower_bound / upper_bound / rank / count 与 std::multiset 上的暴力结果一致
+
+using IntSet = btree::btree_set<int>;
+
+class BTreeSetTest : public ::testing::Test {
+   public:
+    // 根节点的儿子数组较大，放在堆上
+    std::unique_ptr<IntSet> set_ = std::make_unique<IntSet>();
+    std::multiset<int> keys_;  // 与 set_ 中的记录相同
+
+    void Insert(int key) {
+        set_->insert(key);
+        keys_.insert(key);
+    }
+
+    void Erase(int key) {
+        set_->erase(key);
+        keys_.erase(keys_.find(key));
+    }
+
+    // 从 begin 到 end 逐个比较
+    void CheckScan() {
+        auto expect = keys_.begin();
+        for (auto it = set_->begin(); !(it == set_->end()); ++it, ++expect) {
+            ASSERT_TRUE(expect != keys_.end());
+            ASSERT_EQ(*it, *expect);
+        }
+        ASSERT_TRUE(expect == keys_.end());
+    }
+
+    // 检查键 key 的 lower_bound / upper_bound / rank
+    void CheckKey(int key) {
+        auto lower_it = keys_.lower_bound(key);
+        auto upper_it = keys_.upper_bound(key);
+        size_t lower = std::distance(keys_.begin(), lower_it);
+        size_t upper = std::distance(keys_.begin(), upper_it);
+        ASSERT_EQ(set_->rank(key, false), lower) << "key " << key;
+        ASSERT_EQ(set_->rank(key, true), upper) << "key " << key;
+        ASSERT_EQ(set_->contains(key), lower < upper) << "key " << key;
+
+        // 从 lower_bound 开始恰好是所有等于 key 的记录，之后是 upper_bound 指向的记录
+        auto it = set_->lower_bound(key);
+        for (auto expect = lower_it; expect != upper_it; ++expect, ++it) {
+            ASSERT_FALSE(it == set_->end()) << "key " << key;
+            ASSERT_EQ(*it, *expect) << "key " << key;
+        }
+        auto next = set_->upper_bound(key);
+        if (upper_it == keys_.end()) {
+            ASSERT_TRUE(it == set_->end()) << "key " << key;
+            ASSERT_TRUE(next == set_->end()) << "key " << key;
+        } else {
+            ASSERT_FALSE(it == set_->end()) << "key " << key;
+            ASSERT_FALSE(next == set_->end()) << "key " << key;
+            ASSERT_EQ(*it, *upper_it) << "key " << key;
+            ASSERT_EQ(*next, *upper_it) << "key " << key;
+        }
+    }
+
+    void CheckAll(int min_key, int max_key) {
+        ASSERT_EQ(set_->count(), keys_.size());
+        CheckScan();
+        for (int key = min_key - 1; key <= max_key + 1; key++) {
+            CheckKey(key);
+        }
+    }
+};
+
+// 少数几个键各重复几千次，使每个键跨越多个叶子节点，插入顺序打乱
+TEST_F(BTreeSetTest, DuplicateKeysAcrossLeaves) {
+    const int key_range = 16;
+    const int dup_num = 3000;
+    std::vector<int> input;
+    for (int key = 0; key < key_range; key++) {
+        input.insert(input.end(), dup_num, key * 2);  // 只插入偶数，奇数检查落在键之间的情况
+    }
+    std::shuffle(input.begin(), input.end(), std::default_random_engine(0));
+    for (int key : input) {
+        Insert(key);
+    }
+    CheckAll(0, key_range * 2);
+
+    // 删去一部分后再检查，其中一个键删光
+    for (int i = 0; i < dup_num; i++) {
+        Erase(6);
+        if (i % key_range != 3) {
+            Erase(i % key_range * 2);
+        }
+    }
+    CheckAll(0, key_range * 2);
+}
+
+// 记录数足以使根节点下的中间节点分裂，重复键跨越相邻的中间节点
+TEST_F(BTreeSetTest, DuplicateKeysAcrossMidNodes) {
+    const int key_range = 64;
+    const int insert_num = 200000;
+    std::default_random_engine engine(1);
+    std::uniform_int_distribution<int> dist(0, key_range - 1);
+    for (int i = 0; i < insert_num; i++) {
+        // 一半记录集中在 key_range / 2 上
+        Insert(i % 2 == 0 ? key_range / 2 : dist(engine));
+    }
+    CheckAll(0, key_range);
+
+    std::vector<int> erase_keys(keys_.begin(), keys_.end());
+    std::shuffle(erase_keys.begin(), erase_keys.end(), engine);
+    erase_keys.resize(erase_keys.size() * 3 / 4);
+    for (int key : erase_keys) {
+        Erase(key);
+    }
+    CheckAll(0, key_range);
+}
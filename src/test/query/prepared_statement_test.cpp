@@ -0,0 +1,136 @@
+#include <unistd.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "analyze/analyze_finals.h"
+#include "plan_cache_finals.h"
+#include "portal_finals.h"
+
+// 预备语句的占位符：子查询中的占位符不会被绑定，无论是否在 PREPARE 中都要报错，而不是带着未绑定的参数执行
+
+int Context::MAX_OFFSET_LENGTH = BUFFER_LENGTH >> 1;
+
+class PreparedStatementTest : public ::testing::Test {
+   public:
+    static PoolManager memory_pool_manager_;
+    static std::unique_ptr<SmManager> sm_manager_;
+    static std::unique_ptr<LockManager> lock_manager_;
+    static std::unique_ptr<TransactionManager> txn_manager_;
+    static std::unique_ptr<Planner> planner_;
+    static std::unique_ptr<Optimizer> optimizer_;
+    static std::unique_ptr<QlManager> ql_manager_;
+    static std::unique_ptr<Portal> portal_;
+    static std::unique_ptr<Analyze> analyze_;
+    static std::string dir_;
+
+    SqlParser parser_;
+    char data_send_[BUFFER_LENGTH];
+    int offset_ = 0;
+    std::unique_ptr<Context> context_;
+    std::unique_ptr<PlanCache> plan_cache_;
+
+    static void SetUpTestSuite() {
+        sm_manager_ = std::make_unique<SmManager>(&memory_pool_manager_);
+        lock_manager_ = std::make_unique<LockManager>(&memory_pool_manager_);
+        txn_manager_ = std::make_unique<TransactionManager>(sm_manager_.get(), lock_manager_.get());
+        planner_ = std::make_unique<Planner>(sm_manager_.get());
+        optimizer_ = std::make_unique<Optimizer>(planner_.get());
+        ql_manager_ = std::make_unique<QlManager>(sm_manager_.get(), txn_manager_.get(), planner_.get());
+        portal_ = std::make_unique<Portal>(sm_manager_.get());
+        analyze_ = std::make_unique<Analyze>(sm_manager_.get());
+
+        char dir[] = "/tmp/prepared_statement_test.XXXXXX";
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        dir_ = dir;
+        ASSERT_EQ(chdir(dir), 0);
+        sm_manager_->create_db("db");
+        sm_manager_->open_db("db");
+        sm_manager_->io_enabled_ = false;
+    }
+
+    static void TearDownTestSuite() {
+        std::string cmd = "rm -rf " + dir_;
+        ASSERT_EQ(chdir("/"), 0);
+        ASSERT_EQ(system(cmd.c_str()), 0);
+    }
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        context_ = std::make_unique<Context>(lock_manager_.get(), txn_manager_->begin(nullptr), data_send_, &offset_);
+        context_->txn_->set_txn_mode(false);
+        plan_cache_ = std::make_unique<PlanCache>(sm_manager_.get(), analyze_.get(), optimizer_.get());
+        if (!sm_manager_->db_.is_table("t")) {
+            Run("create table t (a int);");
+            Run("create table u (b int, c int);");
+        }
+    }
+
+    void TearDown() override { txn_manager_->commit(context_->txn_); }
+
+    std::shared_ptr<ast::TreeNode> Parse(const std::string &sql) {
+        std::shared_ptr<ast::TreeNode> parse_tree;
+        EXPECT_TRUE(parser_.parse(sql.c_str(), parse_tree)) << sql;
+        EXPECT_NE(parse_tree, nullptr) << sql;
+        return parse_tree;
+    }
+
+    void Run(const std::string &sql) {
+        auto plan = optimizer_->plan_query(analyze_->do_analyze(Parse(sql)), context_.get());
+        auto portal_stmt = portal_->start(plan, context_.get());
+        txn_id_t txn_id = context_->txn_->txn_id_;
+        Portal::run(portal_stmt, ql_manager_.get(), &txn_id, context_.get());
+    }
+
+    void Prepare(const std::string &sql) {
+        auto x = std::dynamic_pointer_cast<ast::PrepareStmt>(Parse(sql));
+        ASSERT_NE(x, nullptr) << sql;
+        plan_cache_->prepare(x->name, x->stmt, context_.get());
+    }
+
+    std::shared_ptr<Plan> Execute(const std::string &sql) {
+        auto x = std::dynamic_pointer_cast<ast::ExecuteStmt>(Parse(sql));
+        EXPECT_NE(x, nullptr) << sql;
+        return plan_cache_->bind(x->name, x->vals, context_.get());
+    }
+};
+
+PoolManager PreparedStatementTest::memory_pool_manager_;
+std::unique_ptr<SmManager> PreparedStatementTest::sm_manager_;
+std::unique_ptr<LockManager> PreparedStatementTest::lock_manager_;
+std::unique_ptr<TransactionManager> PreparedStatementTest::txn_manager_;
+std::unique_ptr<Planner> PreparedStatementTest::planner_;
+std::unique_ptr<Optimizer> PreparedStatementTest::optimizer_;
+std::unique_ptr<QlManager> PreparedStatementTest::ql_manager_;
+std::unique_ptr<Portal> PreparedStatementTest::portal_;
+std::unique_ptr<Analyze> PreparedStatementTest::analyze_;
+std::string PreparedStatementTest::dir_;
+
+// 普通语句的子查询中有占位符
+TEST_F(PreparedStatementTest, PlaceholderInSubquery) {
+    EXPECT_THROW(analyze_->do_analyze(Parse("select * from t where a in (select b from u where c = $1);")), RMDBError);
+    EXPECT_THROW(analyze_->do_analyze(Parse("select * from t where a = (select b from u where c = $1);")), RMDBError);
+    // 外层查询的占位符计入 param_num，服务器据此拒绝 PREPARE 之外的占位符
+    EXPECT_EQ(analyze_->do_analyze(Parse("select * from t where a = $1;"))->param_num, 1u);
+}
+
+// PREPARE 的子查询中有占位符，预备语句不会被缓存
+TEST_F(PreparedStatementTest, PlaceholderInPreparedSubquery) {
+    EXPECT_THROW(Prepare("prepare p as select * from t where a in (select b from u where c = $1);"), RMDBError);
+    EXPECT_THROW(Execute("execute p(1);"), RMDBError);
+    EXPECT_THROW(Prepare("prepare q as select * from t where a = (select b from u where c = $1);"), RMDBError);
+    EXPECT_THROW(Execute("execute q(1);"), RMDBError);
+}
+
+// 外层查询中的占位符照常绑定，参数个数不符时报错
+TEST_F(PreparedStatementTest, PlaceholderInOuterQuery) {
+    Prepare("prepare p as select * from t where a = $1;");
+    auto plan = Execute("execute p(7);");
+    ASSERT_NE(plan, nullptr);
+    EXPECT_THROW(Execute("execute p(7, 8);"), RMDBError);
+    EXPECT_THROW(Execute("execute p;"), RMDBError);
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "common/value_finals.h"
+
+// 一个字段上的区间树，锁管理器用它按字段值找出可能冲突的锁。
+// 区间按下界排序，节点记录子树中最大的上界：查找时跳过最大上界小于查找范围下界的子树，以及下界大于查找范围上界的右子树。
+// 用随机优先级（treap）保持平衡，插入、删除 O(log n)，查找 O(log n + 结果数)。
+// 不区分区间端点的开闭，找到的区间由调用者精确检查
+template <typename T>
+class IntervalTree
+{
+public:
+    struct Node
+    {
+        Node(const char *low_, int len, const char *high_, T value_, uint32_t priority_) : low(low_, len), high(high_), value(std::move(value_)), priority(priority_) {}
+
+        const char *upper() const { return high != nullptr ? high : low.data(); }
+
+        std::string low;  // 下界的拷贝，区间对应的记录释放后仍能定位节点
+        const char *high; // nullptr 表示单点区间
+        T value;
+        uint32_t priority;
+        const char *max_high = nullptr;
+        Node *left = nullptr;
+        Node *right = nullptr;
+    };
+
+    using Handle = Node *;
+
+    IntervalTree(ColType type, int len) : type_(type), len_(len) {}
+
+    IntervalTree(const IntervalTree &) = delete;
+
+    IntervalTree &operator=(const IntervalTree &) = delete;
+
+    ~IntervalTree() { destroy(root_); }
+
+    // 插入区间 [low, high]，high 为 nullptr 时是单点 low；low 被拷贝，high 指向的内容在删除前须保持不变
+    Handle insert(const char *low, const char *high, T value)
+    {
+        auto node = new Node(low, len_, high, std::move(value), next_priority());
+        root_ = insert(root_, node);
+        return node;
+    }
+
+    void erase(Handle node)
+    {
+        root_ = erase(root_, node);
+        delete node;
+    }
+
+    // 对与 [low, high] 可能相交的每个区间调用 fn(value)
+    template <typename Fn>
+    void query(const char *low, const char *high, Fn &&fn) const
+    {
+        query(root_, low, high, fn);
+    }
+
+private:
+    int compare(const char *a, const char *b) const
+    {
+        switch (type_)
+        {
+        case TYPE_INT:
+        {
+            int ia, ib;
+            memcpy(&ia, a, sizeof(int));
+            memcpy(&ib, b, sizeof(int));
+            return (ia > ib) - (ia < ib);
+        }
+        case TYPE_FLOAT:
+        {
+            float fa, fb;
+            memcpy(&fa, a, sizeof(float));
+            memcpy(&fb, b, sizeof(float));
+            return (fa > fb) - (fa < fb);
+        }
+        default:
+            return memcmp(a, b, len_);
+        }
+    }
+
+    // 下界相同的区间按 value 排序，使每个节点的位置唯一
+    bool less(const Node *a, const Node *b) const
+    {
+        int cmp = compare(a->low.data(), b->low.data());
+        return cmp != 0 ? cmp < 0 : std::less<T>()(a->value, b->value);
+    }
+
+    Node *pull(Node *node) const
+    {
+        node->max_high = node->upper();
+        for (auto child : {node->left, node->right})
+        {
+            if (child != nullptr && compare(child->max_high, node->max_high) > 0)
+            {
+                node->max_high = child->max_high;
+            }
+        }
+        return node;
+    }
+
+    // 把 tree 分成小于 key 和不小于 key 的两部分
+    void split(Node *tree, const Node *key, Node *&left, Node *&right) const
+    {
+        if (tree == nullptr)
+        {
+            left = right = nullptr;
+            return;
+        }
+        if (less(tree, key))
+        {
+            split(tree->right, key, tree->right, right);
+            left = pull(tree);
+        }
+        else
+        {
+            split(tree->left, key, left, tree->left);
+            right = pull(tree);
+        }
+    }
+
+    // left 中的节点都小于 right 中的节点
+    Node *merge(Node *left, Node *right) const
+    {
+        if (left == nullptr || right == nullptr)
+        {
+            return left != nullptr ? left : right;
+        }
+        if (left->priority > right->priority)
+        {
+            left->right = merge(left->right, right);
+            return pull(left);
+        }
+        right->left = merge(left, right->left);
+        return pull(right);
+    }
+
+    Node *insert(Node *tree, Node *node) const
+    {
+        if (tree == nullptr)
+        {
+            return pull(node);
+        }
+        if (node->priority > tree->priority)
+        {
+            split(tree, node, node->left, node->right);
+            return pull(node);
+        }
+        if (less(node, tree))
+        {
+            tree->left = insert(tree->left, node);
+        }
+        else
+        {
+            tree->right = insert(tree->right, node);
+        }
+        return pull(tree);
+    }
+
+    Node *erase(Node *tree, Node *node) const
+    {
+        if (tree == nullptr)
+        {
+            return nullptr;
+        }
+        if (tree == node)
+        {
+            return merge(tree->left, tree->right);
+        }
+        if (less(node, tree))
+        {
+            tree->left = erase(tree->left, node);
+        }
+        else
+        {
+            tree->right = erase(tree->right, node);
+        }
+        return pull(tree);
+    }
+
+    template <typename Fn>
+    void query(const Node *tree, const char *low, const char *high, Fn &fn) const
+    {
+        if (tree == nullptr || compare(tree->max_high, low) < 0)
+        {
+            return;
+        }
+        query(tree->left, low, high, fn);
+        if (compare(tree->low.data(), high) > 0)
+        {
+            return;
+        }
+        if (compare(tree->upper(), low) >= 0)
+        {
+            fn(tree->value);
+        }
+        query(tree->right, low, high, fn);
+    }
+
+    static void destroy(Node *tree)
+    {
+        if (tree != nullptr)
+        {
+            destroy(tree->left);
+            destroy(tree->right);
+            delete tree;
+        }
+    }
+
+    uint32_t next_priority()
+    {
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        return seed_;
+    }
+
+    ColType type_;
+    int len_;
+    Node *root_ = nullptr;
+    uint32_t seed_ = 2463534242u;
+};
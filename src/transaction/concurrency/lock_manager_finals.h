@@ -1,19 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
-#include <shared_mutex>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "common/config_finals.h"
+#include "common/simd_filter_finals.h"
 #include "common/value_finals.h"
+#include "interval_tree_finals.h"
 #include "storage/memory_pool_manager.h"
 #include "transaction/transaction_finals.h"
 
 class Gap
 {
     friend class IndexScanExecutor;
+    friend class IndexAggExecutor;
+    friend class LockManager;
 
 public:
     Gap(TabMeta *tab_meta, char *upper, char *lower, std::vector<int> upper_is_closed, std::vector<int> lower_is_closed, const std::vector<int> &col_idx, PoolManager *memory_pool_manager) : memory_pool_manager_(memory_pool_manager), upper_(upper), lower_(lower), col_tot_len(tab_meta->col_tot_len), upper_is_closed_(std::move(upper_is_closed)), lower_is_closed_(std::move(lower_is_closed))
@@ -23,6 +33,15 @@ public:
         {
             cols.push_back(tab_meta->cols[idx]);
         }
+        for (const auto &col : cols)
+        {
+            bool lower_closed = lower_is_closed_[col.idx], upper_closed = upper_is_closed_[col.idx];
+            checks_.push_back({col.offset, col.len, col.type, lower_closed, upper_closed, lower_ + col.offset, upper_ + col.offset,
+                               range_check_fn(col.type, lower_closed, upper_closed)});
+        }
+        // 字符串字段放在最后，批量过滤时只检查数值字段过滤后剩下的记录
+        std::stable_partition(checks_.begin(), checks_.end(), [](const RangeCheck &check)
+                              { return check.type != TYPE_STRING; });
     }
 
     ~Gap()
@@ -31,127 +50,182 @@ public:
         memory_pool_manager_->deallocate(lower_, col_tot_len);
     }
 
+    // 锁管理器按这个字段索引间隙锁：第一个数值字段，没有时是第一个字段；没有条件（锁全表）时为 nullptr
+    const ColMeta *leading_col() const
+    {
+        if (cols.empty())
+        {
+            return nullptr;
+        }
+        auto it = std::find_if(cols.begin(), cols.end(), [](const ColMeta &col)
+                               { return col.type != TYPE_STRING; });
+        return it != cols.end() ? &*it : &cols.front();
+    }
+
+    // 逐个检查字段是否在范围内，比较函数在构造时按字段类型和区间开闭选定
     bool overlap(const char *key) const
     {
-        for (auto &col : cols)
+        for (const auto &check : checks_)
         {
-            switch (col.type)
+            if (!check.in_range(check, key))
             {
-            case ColType::TYPE_INT:
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 批量过滤 n (<= SIMD_FILTER_BATCH) 条记录，第 i 条满足条件时结果的第 i 位为 1
+    // INT/FLOAT 字段先拷贝成连续数组再用 SIMD 比较，字符串字段只检查之前的字段过滤后剩下的记录
+    uint64_t overlap_batch(char *const *rows, size_t n) const
+    {
+        uint64_t mask = n >= simd_filter::SIMD_FILTER_BATCH ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+        alignas(32) char values[simd_filter::SIMD_FILTER_BATCH * sizeof(int)];
+        for (const auto &check : checks_)
+        {
+            if (mask == 0)
             {
-                auto up = *(int *)(upper_ + col.offset);
-                auto low = *(int *)(lower_ + col.offset);
-                auto value = *(int *)(key + col.offset);
-                if (upper_is_closed_[col.idx])
-                {
-                    if (value > up)
-                    {
-                        return false;
-                    }
-                }
-                else
-                {
-                    if (value >= up)
-                    {
-                        return false;
-                    }
-                }
-                if (lower_is_closed_[col.idx])
-                {
-                    if (value < low)
-                    {
-                        return false;
-                    }
-                }
-                else
-                {
-                    if (value <= low)
-                    {
-                        return false;
-                    }
-                }
                 break;
             }
-            case ColType::TYPE_FLOAT:
+            if (check.type == TYPE_STRING)
             {
-                auto up = *(float *)(upper_ + col.offset);
-                auto low = *(float *)(lower_ + col.offset);
-                auto value = *(float *)(key + col.offset);
-                if (upper_is_closed_[col.idx])
-                {
-                    if (value > up)
-                    {
-                        return false;
-                    }
-                }
-                else
+                for (uint64_t bits = mask; bits != 0; bits &= bits - 1)
                 {
-                    if (value >= up)
+                    int i = __builtin_ctzll(bits);
+                    if (!check.in_range(check, rows[i]))
                     {
-                        return false;
+                        mask &= ~(uint64_t(1) << i);
                     }
                 }
-                if (lower_is_closed_[col.idx])
-                {
-                    if (value < low)
-                    {
-                        return false;
-                    }
-                }
-                else
-                {
-                    if (value <= low)
-                    {
-                        return false;
-                    }
-                }
-                break;
+                continue;
             }
-            case ColType::TYPE_STRING:
+            for (size_t i = 0; i < n; i++)
             {
-                auto up = upper_ + col.offset;
-                auto low = lower_ + col.offset;
-                auto value = key + col.offset;
-
-                auto upcmp = memcmp(value, up, col.len);
-                auto lowcmp = memcmp(value, low, col.len);
+                memcpy(values + i * sizeof(int), rows[i] + check.offset, sizeof(int));
+            }
+            mask &= check.type == TYPE_INT ? batch_range_mask<int>(check, values, n) : batch_range_mask<float>(check, values, n);
+        }
+        return mask;
+    }
 
-                if (upper_is_closed_[col.idx])
-                {
-                    if (upcmp > 0)
-                    {
-                        return false;
-                    }
-                }
-                else
-                {
-                    if (upcmp >= 0)
-                    {
-                        return false;
-                    }
-                }
-                if (lower_is_closed_[col.idx])
-                {
-                    if (lowcmp < 0)
-                    {
-                        return false;
-                    }
-                }
-                else
-                {
-                    if (lowcmp <= 0)
-                    {
-                        return false;
-                    }
-                }
-                break;
+    // 区域映射中一块记录的各字段范围为 [min, max]，与条件的范围都相交时块中才可能有满足条件的记录
+    bool overlap_zone(const char *min, const char *max) const
+    {
+        for (const auto &check : checks_)
+        {
+            int low_cmp = compare_value(check, max + check.offset, check.lower);
+            if (check.lower_closed ? low_cmp < 0 : low_cmp <= 0)
+            {
+                return false;
             }
+            int up_cmp = compare_value(check, min + check.offset, check.upper);
+            if (check.upper_closed ? up_cmp > 0 : up_cmp >= 0)
+            {
+                return false;
             }
         }
         return true;
     }
 
 private:
+    struct RangeCheck;
+    using RangeCheckFn = bool (*)(const RangeCheck &check, const char *key);
+
+    // 一个字段的范围检查，上下界指向 upper_、lower_ 中的该字段
+    struct RangeCheck
+    {
+        int offset;
+        int len;
+        ColType type;
+        bool lower_closed;
+        bool upper_closed;
+        const char *lower;
+        const char *upper;
+        RangeCheckFn in_range;
+    };
+
+    template <ColType type, bool lower_closed, bool upper_closed>
+    static bool check_range(const RangeCheck &check, const char *key)
+    {
+        const char *value = key + check.offset;
+        int up_cmp, low_cmp;
+        if constexpr (type == TYPE_STRING)
+        {
+            up_cmp = memcmp(value, check.upper, check.len);
+            low_cmp = memcmp(value, check.lower, check.len);
+        }
+        else
+        {
+            using T = std::conditional_t<type == TYPE_INT, int, float>;
+            T v, low, up;
+            memcpy(&v, value, sizeof(T));
+            memcpy(&low, check.lower, sizeof(T));
+            memcpy(&up, check.upper, sizeof(T));
+            up_cmp = (v > up) - (v < up);
+            low_cmp = (v > low) - (v < low);
+        }
+        if (upper_closed ? up_cmp > 0 : up_cmp >= 0)
+        {
+            return false;
+        }
+        return lower_closed ? low_cmp >= 0 : low_cmp > 0;
+    }
+
+    static int compare_value(const RangeCheck &check, const char *a, const char *b)
+    {
+        switch (check.type)
+        {
+        case TYPE_INT:
+        {
+            int ia, ib;
+            memcpy(&ia, a, sizeof(int));
+            memcpy(&ib, b, sizeof(int));
+            return (ia > ib) - (ia < ib);
+        }
+        case TYPE_FLOAT:
+        {
+            float fa, fb;
+            memcpy(&fa, a, sizeof(float));
+            memcpy(&fb, b, sizeof(float));
+            return (fa > fb) - (fa < fb);
+        }
+        default:
+            return memcmp(a, b, check.len);
+        }
+    }
+
+    template <typename T>
+    static uint64_t batch_range_mask(const RangeCheck &check, const char *values, size_t n)
+    {
+        T low, up;
+        memcpy(&low, check.lower, sizeof(T));
+        memcpy(&up, check.upper, sizeof(T));
+        return simd_filter::range_mask(reinterpret_cast<const T *>(values), n, low, up, check.lower_closed, check.upper_closed);
+    }
+
+    template <ColType type>
+    static RangeCheckFn typed_range_check_fn(bool lower_closed, bool upper_closed)
+    {
+        if (lower_closed)
+        {
+            return upper_closed ? &check_range<type, true, true> : &check_range<type, true, false>;
+        }
+        return upper_closed ? &check_range<type, false, true> : &check_range<type, false, false>;
+    }
+
+    static RangeCheckFn range_check_fn(ColType type, bool lower_closed, bool upper_closed)
+    {
+        switch (type)
+        {
+        case TYPE_INT:
+            return typed_range_check_fn<TYPE_INT>(lower_closed, upper_closed);
+        case TYPE_FLOAT:
+            return typed_range_check_fn<TYPE_FLOAT>(lower_closed, upper_closed);
+        default:
+            return typed_range_check_fn<TYPE_STRING>(lower_closed, upper_closed);
+        }
+    }
+
     PoolManager *memory_pool_manager_;
     char *upper_;
     char *lower_;
@@ -159,8 +233,14 @@ private:
     std::vector<ColMeta> cols;
     std::vector<int> upper_is_closed_;
     std::vector<int> lower_is_closed_;
+    std::vector<RangeCheck> checks_;
 };
 
+
+// 间隙锁按首字段（Gap::leading_col）放入该字段的区间树，没有条件的间隙锁只计数。
+// 数据锁按事务放在哈希表中；某个字段第一次成为间隙锁的首字段时，为该字段建立数据锁的区间树（单点区间），之后的数据锁同时插入。
+// 这样加锁时的冲突检查只查找相交的区间，不再遍历表上所有的锁。
+// 冲突时较新的事务回滚；较老的事务应等待（wait-die），抛出 TransactionWaitException，由调用者撤销当前语句，在有锁释放后重新执行
 class LockManager
 {
 public:
@@ -169,27 +249,49 @@ public:
     Gap *lock_shared_on_gap(const std::shared_ptr<Transaction> &txn, int fd, TabMeta *tab_meta, char *upper, char *lower, const std::vector<int> &upper_is_closed, const std::vector<int> &lower_is_closed, const std::vector<int> &col_idx)
     {
         auto gap = std::make_shared<Gap>(tab_meta, upper, lower, upper_is_closed, lower_is_closed, col_idx, memory_pool_manager_);
-        while (lock_shared_on_gap(txn, gap, fd))
+        auto col = gap->leading_col();
+        auto &table = tables_[fd];
+        std::lock_guard lock(latch_[fd]);
+        if (gap_conflicts(txn, table, *gap, col))
+        {
+            throw TransactionWaitException(fd, release_epochs_[fd]);
+        }
+
+        auto &locks = table.txns[txn->txn_id_];
+        GapTree *tree = nullptr;
+        GapTree::Handle handle = nullptr;
+        if (col != nullptr)
         {
-            std::this_thread::yield();
+            tree = col_tree(table.gap_trees, *col);
+            handle = tree->insert(gap->lower_ + col->offset, gap->upper_ + col->offset, {txn->txn_id_, gap.get()});
         }
+        else
         {
-            std::unique_lock lock(latch_[fd]);
-            tab_lock_map_[fd][txn->txn_id_].push_back(std::move(gap));
-            txn->gap_lock_map_.insert(fd);
-            return tab_lock_map_[fd][txn->txn_id_].back().get();
+            locks.whole_table_gaps++;
+            table.whole_table_gaps++;
         }
+        locks.gaps.push_back({std::move(gap), tree, handle});
+        txn->gap_lock_map_.insert(fd);
+        return locks.gaps.back().gap.get();
     }
 
     void lock_exclusive_on_data(const std::shared_ptr<Transaction> &txn, int fd, char *rid_)
     {
-        while (lock_on_data(txn, fd, rid_))
+        auto &table = tables_[fd];
+        std::lock_guard lock(latch_[fd]);
+        if (data_conflicts(txn, table, rid_))
         {
-            std::this_thread::yield();
+            throw TransactionWaitException(fd, release_epochs_[fd]);
         }
+
+        // 同一条记录只登记一次
+        auto [it, inserted] = table.txns[txn->txn_id_].rids.try_emplace(rid_);
+        if (inserted)
         {
-            std::unique_lock lock(latch_[fd]);
-            data_lock_map_[fd][txn->txn_id_].push_back(rid_);
+            for (auto &data_tree : table.data_trees)
+            {
+                it->second.push_back(data_tree.tree->insert(rid_ + data_tree.offset, nullptr, {txn->txn_id_, rid_}));
+            }
         }
         txn->data_lock_map_.emplace(fd);
     }
@@ -198,73 +300,206 @@ public:
     {
         for (auto fd : txn->gap_lock_map_)
         {
-            std::unique_lock lock(latch_[fd]);
-            tab_lock_map_[fd].erase(txn->txn_id_);
+            release(txn->txn_id_, fd);
         }
         for (auto fd : txn->data_lock_map_)
         {
-            std::unique_lock lock(latch_[fd]);
-            data_lock_map_[fd].erase(txn->txn_id_);
+            if (txn->gap_lock_map_.count(fd) == 0)
+            {
+                release(txn->txn_id_, fd);
+            }
         }
     }
 
+    // 表 fd 上每次释放锁时加一
+    uint64_t release_epoch(int fd) const { return release_epochs_[fd]; }
+
+    // 释放表 fd 上的锁后调用 callback(fd)，服务端在这里重新调度等待这张表上的锁的语句
+    void set_release_callback(std::function<void(int)> callback) { release_callback_ = std::move(callback); }
+
 private:
+    using GapTree = IntervalTree<std::pair<txn_id_t, Gap *>>;
+    using DataTree = IntervalTree<std::pair<txn_id_t, char *>>;
+
+    struct GapLock
+    {
+        std::shared_ptr<Gap> gap;
+        GapTree *tree; // 锁全表时为 nullptr
+        GapTree::Handle handle;
+    };
+
+    // 一个事务在表上持有的锁，数据锁的第 i 个句柄属于 TableLocks::data_trees 中的第 i 棵树
+    struct TxnLocks
+    {
+        std::vector<GapLock> gaps;
+        int whole_table_gaps = 0;
+        std::unordered_map<char *, std::vector<DataTree::Handle>> rids;
+    };
+
+    template <typename Tree>
+    struct ColTree
+    {
+        int col_idx;
+        int offset;
+        std::unique_ptr<Tree> tree;
+    };
+
+    // 表上的锁；没有事务持有锁时清空区间树，表删除后重建时字段可能不同
+    struct TableLocks
+    {
+        std::map<txn_id_t, TxnLocks> txns;
+        std::vector<ColTree<GapTree>> gap_trees;
+        std::vector<ColTree<DataTree>> data_trees;
+        int whole_table_gaps = 0;
+    };
+
     PoolManager *memory_pool_manager_;
-    std::shared_mutex latch_[MAX_TABLE_NUMBER];
-    std::map<txn_id_t, std::vector<std::shared_ptr<Gap>>> tab_lock_map_[MAX_TABLE_NUMBER];
-    std::map<txn_id_t, std::vector<char *>> data_lock_map_[MAX_TABLE_NUMBER];
+    std::mutex latch_[MAX_TABLE_NUMBER];
+    TableLocks tables_[MAX_TABLE_NUMBER];
+    std::atomic<uint64_t> release_epochs_[MAX_TABLE_NUMBER]{};
+    std::function<void(int)> release_callback_;
 
-    bool lock_shared_on_gap(const std::shared_ptr<Transaction> &txn, std::shared_ptr<Gap> &gap, int fd)
+    template <typename Tree>
+    static Tree *find_col_tree(std::vector<ColTree<Tree>> &trees, const ColMeta &col)
     {
-        std::shared_lock lock(latch_[fd]);
-        for (auto &[data_txn_id_, lock_ids_] : data_lock_map_[fd])
+        for (auto &col_tree : trees)
         {
-            if (data_txn_id_ == txn->txn_id_)
+            if (col_tree.col_idx == col.idx)
             {
-                continue;
+                return col_tree.tree.get();
             }
-            for (auto lock_id_ : lock_ids_)
+        }
+        return nullptr;
+    }
+
+    template <typename Tree>
+    static Tree *col_tree(std::vector<ColTree<Tree>> &trees, const ColMeta &col)
+    {
+        if (auto tree = find_col_tree(trees, col))
+        {
+            return tree;
+        }
+        trees.push_back({col.idx, col.offset, std::make_unique<Tree>(col.type, col.len)});
+        return trees.back().tree.get();
+    }
+
+    // 字段上还没有数据锁的区间树时，把已有的数据锁插入新建的树
+    static DataTree *data_tree(TableLocks &table, const ColMeta &col)
+    {
+        if (auto tree = find_col_tree(table.data_trees, col))
+        {
+            return tree;
+        }
+        auto tree = col_tree(table.data_trees, col);
+        for (auto &[txn_id, locks] : table.txns)
+        {
+            for (auto &[rid, handles] : locks.rids)
+            {
+                handles.push_back(tree->insert(rid + col.offset, nullptr, {txn_id, rid}));
+            }
+        }
+        return tree;
+    }
+
+    // 与持有者冲突：当前事务更老时应等待（返回 true），否则回滚
+    static void conflict(const std::shared_ptr<Transaction> &txn, txn_id_t holder, bool &wait)
+    {
+        if (txn->txn_id_ < holder)
+        {
+            wait = true;
+        }
+        else
+        {
+            throw TransactionAbortException();
+        }
+    }
+
+    static bool gap_conflicts(const std::shared_ptr<Transaction> &txn, TableLocks &table, const Gap &gap, const ColMeta *col)
+    {
+        bool wait = false;
+        if (col == nullptr)
+        {
+            for (auto &[holder, locks] : table.txns)
             {
-                if (gap->overlap(lock_id_))
+                if (holder != txn->txn_id_ && !locks.rids.empty())
                 {
-                    if (txn->txn_id_ < data_txn_id_)
-                    {
-                        return true;
-                    }
-                    else
-                    {
-                        throw TransactionAbortException();
-                    }
+                    conflict(txn, holder, wait);
+                }
+            }
+            return wait;
+        }
+        data_tree(table, *col)->query(gap.lower_ + col->offset, gap.upper_ + col->offset, [&](const std::pair<txn_id_t, char *> &lock)
+                                      {
+                                          if (lock.first != txn->txn_id_ && gap.overlap(lock.second))
+                                          {
+                                              conflict(txn, lock.first, wait);
+                                          } });
+        return wait;
+    }
+
+    static bool data_conflicts(const std::shared_ptr<Transaction> &txn, TableLocks &table, const char *rid_)
+    {
+        bool wait = false;
+        for (auto &gap_tree : table.gap_trees)
+        {
+            const char *key = rid_ + gap_tree.offset;
+            gap_tree.tree->query(key, key, [&](const std::pair<txn_id_t, Gap *> &lock)
+                                 {
+                                     if (lock.first != txn->txn_id_ && lock.second->overlap(rid_))
+                                     {
+                                         conflict(txn, lock.first, wait);
+                                     } });
+        }
+        if (table.whole_table_gaps > 0)
+        {
+            for (auto &[holder, locks] : table.txns)
+            {
+                if (holder != txn->txn_id_ && locks.whole_table_gaps > 0)
+                {
+                    conflict(txn, holder, wait);
                 }
             }
         }
-        return false;
+        return wait;
     }
 
-    bool lock_on_data(const std::shared_ptr<Transaction> &txn, int fd, char *rid_)
+    void release(txn_id_t txn_id, int fd)
     {
-        std::shared_lock lock(latch_[fd]);
-        for (auto &[gap_txn_id_, gaps_] : tab_lock_map_[fd])
+        auto &table = tables_[fd];
         {
-            if (gap_txn_id_ == txn->txn_id_)
+            std::lock_guard lock(latch_[fd]);
+            auto it = table.txns.find(txn_id);
+            if (it == table.txns.end())
             {
-                continue;
+                return;
             }
-            for (auto &gap_ : gaps_)
+            auto &locks = it->second;
+            for (auto &gap_lock : locks.gaps)
             {
-                if (gap_->overlap(rid_))
+                if (gap_lock.tree != nullptr)
                 {
-                    if (txn->txn_id_ < gap_txn_id_)
-                    {
-                        return true;
-                    }
-                    else
-                    {
-                        throw TransactionAbortException();
-                    }
+                    gap_lock.tree->erase(gap_lock.handle);
                 }
             }
+            table.whole_table_gaps -= locks.whole_table_gaps;
+            for (auto &[rid, handles] : locks.rids)
+            {
+                for (size_t i = 0; i < handles.size(); i++)
+                {
+                    table.data_trees[i].tree->erase(handles[i]);
+                }
+            }
+            table.txns.erase(it);
+            if (table.txns.empty())
+            {
+                table.gap_trees.clear();
+                table.data_trees.clear();
+            }
+            release_epochs_[fd]++;
+        }
+        if (release_callback_)
+        {
+            release_callback_(fd);
         }
-        return false;
     }
 };
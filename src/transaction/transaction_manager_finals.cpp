@@ -50,12 +50,18 @@ void TransactionManager::commit(const std::shared_ptr<Transaction> &txn)
 }
 
 void TransactionManager::abort(const std::shared_ptr<Transaction> &txn)
+{
+    rollback(txn, 0);
+    finished(txn);
+}
+
+void TransactionManager::rollback(const std::shared_ptr<Transaction> &txn, size_t savepoint)
 {
     // 获取事务的写集合
     auto &write_set = txn->write_set_;
 
-    // 回滚所有写操作
-    while (!write_set.empty())
+    // 回滚保存点之后的写操作
+    while (write_set.size() > savepoint)
     {
         auto write_record = write_set.back(); // 获取最后一个写记录
         write_set.pop_back();                 // 移除最后一个写记录
@@ -100,8 +106,6 @@ void TransactionManager::abort(const std::shared_ptr<Transaction> &txn)
         }
         }
     }
-
-    finished(txn);
 }
 
 void TransactionManager::finished(const std::shared_ptr<Transaction> &txn)
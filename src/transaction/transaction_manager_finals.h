@@ -25,6 +25,9 @@ public:
 
     void abort(const std::shared_ptr<Transaction> &txn);
 
+    // 撤销写集合中 savepoint 之后的写操作，事务继续进行；用于重新执行等待锁的语句
+    void rollback(const std::shared_ptr<Transaction> &txn, size_t savepoint);
+
     std::shared_ptr<Transaction> get_transaction(const txn_id_t &txn_id)
     {
         if (txn_id == INVALID_TXN_ID)